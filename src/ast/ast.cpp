@@ -1,6 +1,7 @@
 // SigNum AST
 
 #include "ast.hpp"
+#include <cctype>
 
 // ノード型を文字列に変換する関数
 std::string nodeType2String(NodeType type) {
@@ -15,6 +16,7 @@ std::string nodeType2String(NodeType type) {
         case NodeType::MemoryRef: return "MemoryRef";
         case NodeType::Number: return "Number";
         case NodeType::String: return "String";
+        case NodeType::Constant: return "Constant";
         case NodeType::Symbol: return "Symbol";
         case NodeType::Operator: return "Operator";
         case NodeType::Comparison: return "Comparison";
@@ -38,6 +40,128 @@ std::string nodeType2String(NodeType type) {
     }
 }
 
+// 演算子を文字列に変換する関数
+std::string operator2String(Operator op) {
+    switch (op) {
+        case Operator::None: return "";
+        case Operator::Add: return "+";
+        case Operator::Subtract: return "-";
+        case Operator::Multiply: return "*";
+        case Operator::Divide: return "/";
+        case Operator::Modulus: return "%";
+        case Operator::Equal: return "==";
+        case Operator::NotEqual: return "!=";
+        case Operator::Less: return "<";
+        case Operator::LessEqual: return "<=";
+        case Operator::Greater: return ">";
+        case Operator::GreaterEqual: return ">=";
+        case Operator::And: return "&&";
+        case Operator::Or: return "||";
+        case Operator::Not: return "!";
+        case Operator::IntCast: return "int";
+        case Operator::FloatCast: return "float";
+        case Operator::StringCast: return "string";
+        case Operator::BoolCast: return "bool";
+        case Operator::CharToInt: return "charToInt";
+        case Operator::IntToChar: return "intToChar";
+        case Operator::IntegerStackPush: return "IntegerStackPush";
+        case Operator::IntegerStackPop: return "IntegerStackPop";
+        case Operator::FloatStackPush: return "FloatStackPush";
+        case Operator::FloatStackPop: return "FloatStackPop";
+        case Operator::StringStackPush: return "StringStackPush";
+        case Operator::StringStackPop: return "StringStackPop";
+        case Operator::BooleanStackPush: return "BooleanStackPush";
+        case Operator::BooleanStackPop: return "BooleanStackPop";
+        default: return "Unknown";
+    }
+}
+
+// 数値リテラルを定数にする
+std::shared_ptr<const Value> ConstantPool::number(const std::string& text) {
+    auto it = numbers.find(text);
+    if (it != numbers.end()) {
+        return it->second;
+    }
+
+    std::shared_ptr<const Value> constant;
+    try {
+        if (text.find('.') != std::string::npos) {
+            constant = std::make_shared<const Value>(std::stod(text));
+        } else {
+            constant = std::make_shared<const Value>(std::stoi(text));
+        }
+    }
+    catch (const std::exception&) {
+        return nullptr; // 実行時にエラーにする
+    }
+    numbers[text] = constant;
+    return constant;
+}
+
+// 文字列リテラルを定数にする
+std::shared_ptr<const Value> ConstantPool::string(const std::string& text) {
+    auto& constant = strings[text];
+    if (!constant) {
+        constant = std::make_shared<const Value>(text);
+    }
+    return constant;
+}
+
+// メモリ参照文字列を解析
+MemoryDescriptor decodeMemoryRef(const std::string& ref) {
+    MemoryDescriptor mem;
+    size_t pos = 0;
+    bool outer = true;
+
+    // 型記号を外側から順に読む
+    while (true) {
+        if (pos >= ref.size() || ref[pos] != '$') {
+            return MemoryDescriptor();
+        }
+        ++pos;
+        if (outer && pos < ref.size() && ref[pos] == '^') {
+            mem.isMap = true;
+            ++pos;
+        }
+        if (pos >= ref.size() ||
+            (ref[pos] != '#' && ref[pos] != '@' && ref[pos] != '~' && ref[pos] != '%')) {
+            return MemoryDescriptor();
+        }
+        if (outer) {
+            mem.type = ref[pos];
+        }
+        else {
+            mem.indirection += ref[pos];
+        }
+        ++pos;
+        outer = false;
+
+        if (pos < ref.size() && ref[pos] == '$') {
+            continue; // ネストされた参照
+        }
+        break;
+    }
+
+    // インデックスなしのメモリマップ参照は先頭を指す
+    if (pos == ref.size()) {
+        mem.valid = mem.isMap && mem.indirection.empty();
+        return mem;
+    }
+
+    // インデックス（数字のみ）
+    if (ref.size() - pos > 9) {
+        return MemoryDescriptor();
+    }
+    for (size_t i = pos; i < ref.size(); ++i) {
+        if (!isdigit(static_cast<unsigned char>(ref[i]))) {
+            return MemoryDescriptor();
+        }
+    }
+    mem.index = std::stoi(ref.substr(pos));
+    mem.valid = true;
+    return mem;
+}
+
 // コンストラクタ
 ASTNode::ASTNode(NodeType type, const std::string& value)
     : type(type), value(value) {}
@@ -2,11 +2,18 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <iostream>
 #include <string>
 #include <vector>
 #include <memory>
 #include <fstream>
+#include <variant>
+#include <unordered_map>
+
+// 値の型
+using Value = std::variant<int, double, std::string, bool>;
 
 // ASTノードの種類
 enum class NodeType {
@@ -20,6 +27,7 @@ enum class NodeType {
     MemoryRef,
     Number,
     String,
+    Constant, // 最適化で求めた定数
     Symbol,
     Operator,
     Comparison,
@@ -44,11 +52,91 @@ enum class NodeType {
 // ノード型を文字列に変換
 std::string nodeType2String(NodeType type);
 
+// 演算子・操作の種類（構文解析時に決まる）
+enum class Operator : uint8_t {
+    None,
+    // 算術演算
+    Add,
+    Subtract,
+    Multiply,
+    Divide,
+    Modulus,
+    // 比較演算
+    Equal,
+    NotEqual,
+    Less,
+    LessEqual,
+    Greater,
+    GreaterEqual,
+    // 論理演算
+    And,
+    Or,
+    Not,
+    // 型変換
+    IntCast,
+    FloatCast,
+    StringCast,
+    BoolCast,
+    // 文字コード変換
+    CharToInt,
+    IntToChar,
+    // スタック操作
+    IntegerStackPush,
+    IntegerStackPop,
+    FloatStackPush,
+    FloatStackPop,
+    StringStackPush,
+    StringStackPop,
+    BooleanStackPush,
+    BooleanStackPop
+};
+
+// 演算子を文字列に変換
+std::string operator2String(Operator op);
+
+// 演算ノードの特殊化状態（実行時に最初に見た被演算子の型で決まる）
+enum class Specialization : uint8_t {
+    Unspecialized, // まだ実行されていない
+    IntInt,        // int同士
+    FloatFloat,    // double同士
+    Generic        // 型が混在した（以後は汎用処理）
+};
+
+// メモリ参照の解析結果（構文解析時に1度だけ作る）
+struct MemoryDescriptor {
+    bool valid = false;       // 解析に成功したか
+    bool isMap = false;       // メモリマップ参照 ($^) か
+    char type = '\0';         // 型記号 ('#', '@', '~', '%')
+    int index = 0;            // 一番内側の静的インデックス
+    std::string indirection;  // ネストされた参照の型記号（外側から順）。$#$@1なら"@"
+};
+
+// メモリ参照文字列 ($#1, $#$#1, $^~3 など) を解析
+MemoryDescriptor decodeMemoryRef(const std::string& ref);
+
+// リテラル定数のプール（構文解析時に1度だけ値にする。同じリテラルは共有する）
+class ConstantPool {
+private:
+    std::unordered_map<std::string, std::shared_ptr<const Value>> numbers;
+    std::unordered_map<std::string, std::shared_ptr<const Value>> strings;
+
+public:
+    // 数値リテラル（小数点があればdouble、範囲外ならnullptr）
+    std::shared_ptr<const Value> number(const std::string& text);
+    // 文字列リテラル
+    std::shared_ptr<const Value> string(const std::string& text);
+};
+
 // ASTノード
 struct ASTNode {
     NodeType type; // ノードの種類
     std::string value; // ノードの値
     std::vector<std::shared_ptr<ASTNode>> children; // 子ノードのリスト
+    Operator op = Operator::None; // 演算子・操作の種類（複合代入のAssignmentにも付く）
+    MemoryDescriptor memory; // メモリ参照の解析結果（MemoryRef, MemoryMapRefのみ）
+    // 算術式・比較式の特殊化状態（実行時に書き換える。ASTを共有して並行に実行するので読み書きはrelaxedのatomic）
+    std::atomic<Specialization> specialization{Specialization::Unspecialized};
+    std::shared_ptr<const Value> constant; // 定数値（Number, String, Constant）
 
     ASTNode(NodeType type, const std::string& value = "");
     virtual ~ASTNode() = default;
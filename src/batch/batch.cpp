@@ -0,0 +1,162 @@
+// SigNum Batch Runner
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include "batch.hpp"
+
+namespace fs = std::filesystem;
+
+BatchRunner::BatchRunner(Frontend frontend, Runner runner)
+    : frontend(std::move(frontend)), runner(std::move(runner)) {}
+
+// 解析済みのプログラムを取得
+std::shared_ptr<const BatchRunner::CacheEntry> BatchRunner::lookup(const std::string& source) {
+    size_t key = std::hash<std::string>{}(source);
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        for (const auto& entry : cache[key]) {
+            if (entry->source == source) {
+                return entry;
+            }
+        }
+    }
+
+    // 解析はロックの外で行う（同時に同じソースを解析したら先に登録した方を使う）
+    auto entry = std::make_shared<CacheEntry>();
+    entry->source = source;
+    std::ostringstream errors;
+    entry->program = frontend(source, errors);
+    entry->errors = errors.str();
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto& bucket = cache[key];
+    for (const auto& existing : bucket) {
+        if (existing->source == source) {
+            return existing;
+        }
+    }
+    bucket.push_back(entry);
+    return entry;
+}
+
+// 1つのジョブを実行
+int BatchRunner::runJob(const Job& job, std::ostream& out, std::ostream& err) {
+    std::ifstream file(job.script);
+    if (!file) {
+        err << "Error: Could not open file " << job.script << std::endl;
+        return 1;
+    }
+    std::string source((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    std::ifstream inputFile;
+    std::istringstream noInput;
+    if (!job.input.empty()) {
+        inputFile.open(job.input);
+        if (!inputFile) {
+            err << "Error: Could not open file " << job.input << std::endl;
+            return 1;
+        }
+    }
+
+    // 解析や実行で投げられた例外はこのジョブの失敗にする（他のジョブは続ける）
+    try {
+        std::shared_ptr<const CacheEntry> entry = lookup(source);
+        if (!entry->program) {
+            err << entry->errors;
+            return 1;
+        }
+        return runner(entry->program, job.input.empty() ? static_cast<std::istream&>(noInput) : inputFile, out, err);
+    }
+    catch (const std::exception& e) {
+        err << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
+
+// マニフェストのジョブを並列に実行
+int BatchRunner::run(const std::string& manifest, unsigned threads, const std::string& outputDir) {
+    std::ifstream file(manifest);
+    if (!file) {
+        throw std::runtime_error("Could not open file " + manifest);
+    }
+    std::vector<Job> jobs;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        Job job;
+        if (!(fields >> job.script) || job.script[0] == '#') {
+            continue;
+        }
+        fields >> job.input;
+        jobs.push_back(job);
+    }
+    if (!outputDir.empty()) {
+        fs::create_directories(outputDir);
+    }
+
+    // フレーム出力のときはジョブの結果をマニフェストの順に書き出す
+    struct Result {
+        bool done = false;
+        int exitCode = 0;
+        std::string out;
+        std::string err;
+    };
+    std::vector<Result> results(outputDir.empty() ? jobs.size() : 0);
+    std::mutex resultMutex;
+    std::condition_variable resultReady;
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> failed{0};
+
+    auto worker = [&]() {
+        for (size_t i = next++; i < jobs.size(); i = next++) {
+            int exitCode;
+            if (outputDir.empty()) {
+                std::ostringstream out, err;
+                exitCode = runJob(jobs[i], out, err);
+                std::lock_guard<std::mutex> lock(resultMutex);
+                results[i] = {true, exitCode, out.str(), err.str()};
+                resultReady.notify_all();
+            } else {
+                std::string stem = (fs::path(outputDir) / std::to_string(i + 1)).string();
+                std::ofstream out(stem + ".out"), err(stem + ".err");
+                exitCode = runJob(jobs[i], out, err);
+            }
+            if (exitCode != 0) {
+                ++failed;
+            }
+        }
+    };
+
+    threads = std::max(1u, std::min<unsigned>(threads, static_cast<unsigned>(std::max<size_t>(jobs.size(), 1))));
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back(worker);
+    }
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        Result result;
+        {
+            std::unique_lock<std::mutex> lock(resultMutex);
+            resultReady.wait(lock, [&]() { return results[i].done; });
+            result = std::move(results[i]);
+            results[i] = Result();
+            results[i].done = true;
+        }
+        std::cout << "=== " << (i + 1) << " " << jobs[i].script << " exit=" << result.exitCode
+                  << " stdout=" << result.out.size() << " stderr=" << result.err.size() << "\n"
+                  << result.out << result.err;
+    }
+    for (std::thread& thread : workers) {
+        thread.join();
+    }
+    std::cout.flush();
+
+    std::cerr << "Batch finished: " << jobs.size() << " jobs, " << failed << " failed" << std::endl;
+    return failed == 0 ? 0 : 1;
+}
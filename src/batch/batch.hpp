@@ -0,0 +1,60 @@
+// SigNum Batch Runner
+
+#pragma once
+
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../ast/ast.hpp"
+
+// マニフェストに並んだスクリプトをワーカースレッドで並列に実行する
+//
+// マニフェストは1行に1ジョブ「スクリプトのパス [標準入力にするファイル]」
+// 空行と # で始まる行は無視する
+//
+// 出力先のディレクトリを指定すると、ジョブごとに <番号>.out と <番号>.err に書く
+// 指定しなければ、標準出力にマニフェストの順で次の形式のフレームを続けて書く
+//   === <番号> <パス> exit=<終了コード> stdout=<バイト数> stderr=<バイト数>\n
+//   <標準出力の内容><標準エラーの内容>
+class BatchRunner {
+public:
+    // ソースを検査済みのASTにする（失敗したらerrorsにエラーを書いてnullptr）
+    using Frontend = std::function<std::shared_ptr<ASTNode>(const std::string& code, std::ostream& errors)>;
+    // プログラムを新しいInterpreterで実行して終了コードを返す
+    using Runner = std::function<int(const std::shared_ptr<ASTNode>& program, std::istream& in,
+                                     std::ostream& out, std::ostream& err)>;
+
+private:
+    struct Job {
+        std::string script;
+        std::string input; // 空なら標準入力なし
+    };
+
+    // 解析結果（同じソースのジョブで共有する。ワーカーは同じASTを同時に実行する。
+    // 実行中に書き換わるのは演算の特殊化の状態だけで、atomicに読み書きする）
+    struct CacheEntry {
+        std::string source;
+        std::shared_ptr<ASTNode> program;
+        std::string errors;
+    };
+
+    Frontend frontend;
+    Runner runner;
+    std::mutex cacheMutex;
+    std::unordered_map<size_t, std::vector<std::shared_ptr<const CacheEntry>>> cache;
+
+    // 解析済みのプログラムを取得（なければ解析してキャッシュする）
+    std::shared_ptr<const CacheEntry> lookup(const std::string& source);
+    // 1つのジョブを実行（例外はそのジョブの標準エラーに書いて終了コード1にする）
+    int runJob(const Job& job, std::ostream& out, std::ostream& err);
+
+public:
+    BatchRunner(Frontend frontend, Runner runner);
+
+    // マニフェストのジョブを threads 並列で実行（1つでも失敗したら1を返す）
+    int run(const std::string& manifest, unsigned threads, const std::string& outputDir);
+};
@@ -0,0 +1,126 @@
+// SigNum Native Builder
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include "builder.hpp"
+#include "../transpiler/transpiler.hpp"
+#include "../version.hpp"
+
+namespace fs = std::filesystem;
+
+NativeBuilder::NativeBuilder() {
+    const char* cxx = std::getenv("CXX");
+    compiler = (cxx && *cxx) ? cxx : "c++";
+
+    flags = "-std=c++17 -O2";
+    const char* cxxflags = std::getenv("CXXFLAGS");
+    if (cxxflags && *cxxflags) {
+        flags += " ";
+        flags += cxxflags;
+    }
+
+    cacheDir = defaultCacheDir();
+}
+
+// キャッシュの置き場所
+std::string NativeBuilder::defaultCacheDir() {
+    if (const char* dir = std::getenv("SIGNUM_CACHE_DIR"); dir && *dir) {
+        return dir;
+    }
+    if (const char* dir = std::getenv("XDG_CACHE_HOME"); dir && *dir) {
+        return (fs::path(dir) / "signum").string();
+    }
+    if (const char* home = std::getenv("HOME"); home && *home) {
+        return (fs::path(home) / ".cache" / "signum").string();
+    }
+    return (fs::temp_directory_path() / "signum-cache").string();
+}
+
+// 内容のハッシュ（FNV-1a 64bit）
+uint64_t NativeBuilder::hash(const std::string& data, uint64_t seed) {
+    uint64_t value = seed;
+    for (unsigned char c : data) {
+        value ^= c;
+        value *= 1099511628211ULL;
+    }
+    return value;
+}
+
+// シェルに渡す引数のクオート
+std::string NativeBuilder::shellQuote(const std::string& arg) {
+    std::string result = "'";
+    for (char c : arg) {
+        if (c == '\'') {
+            result += "'\\''";
+        } else {
+            result += c;
+        }
+    }
+    return result + "'";
+}
+
+// プログラムを実行ファイルにする
+void NativeBuilder::build(const std::shared_ptr<ASTNode>& program, const std::string& output) {
+    CppTranspiler transpiler;
+    transpiler.setMapWindowSize(mapWindowSize);
+    std::string source = transpiler.transpile(program);
+
+    // キャッシュのキー（生成ソース・コンパイラ・フラグ・処理系のバージョン）
+    std::string key = source + '\0' + compiler + '\0' + flags + '\0' + SigNum::VERSION;
+    char name[33];
+    std::snprintf(name, sizeof(name), "%016llx%016llx",
+                  static_cast<unsigned long long>(hash(key)),
+                  static_cast<unsigned long long>(hash(key, 0x84222325cbf29ce4ULL)));
+    fs::path binary = fs::path(cacheDir) / name;
+
+    if (fs::exists(binary)) {
+        if (verbose) {
+            std::cout << "Build cache hit: " << binary.string() << std::endl;
+        }
+    } else {
+        fs::create_directories(cacheDir);
+        compile(source, binary.string());
+        if (verbose) {
+            std::cout << "Build cached: " << binary.string() << std::endl;
+        }
+    }
+
+    fs::copy_file(binary, output, fs::copy_options::overwrite_existing);
+    fs::permissions(output, fs::perms::owner_all | fs::perms::group_read | fs::perms::group_exec |
+                            fs::perms::others_read | fs::perms::others_exec);
+}
+
+// ソースをコンパイルしてキャッシュに置く
+void NativeBuilder::compile(const std::string& source, const std::string& binary) {
+    // 途中のファイルは別名で作り、完成してから置き換える
+    std::string suffix = ".tmp" + std::to_string(std::random_device{}() & 0xffffff);
+    std::string sourcePath = binary + suffix + ".cpp";
+    std::string binaryPath = binary + suffix;
+
+    {
+        std::ofstream file(sourcePath);
+        if (!file) {
+            throw std::runtime_error("Failed to write generated source: " + sourcePath);
+        }
+        file << source;
+    }
+
+    std::string command = compiler + " " + flags + " -o " + shellQuote(binaryPath) + " " + shellQuote(sourcePath);
+    if (verbose) {
+        std::cout << command << std::endl;
+    }
+    int status = std::system(command.c_str());
+
+    std::error_code ignored;
+    fs::remove(sourcePath, ignored);
+    if (status != 0 || !fs::exists(binaryPath)) {
+        fs::remove(binaryPath, ignored);
+        throw std::runtime_error("C++ compiler failed: " + command);
+    }
+    fs::rename(binaryPath, binary);
+}
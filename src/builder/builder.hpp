@@ -0,0 +1,39 @@
+// SigNum Native Builder
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "../ast/ast.hpp"
+
+// C++に変換したプログラムをシステムのC++コンパイラで実行ファイルにする
+// 生成したバイナリはC++ソースとコンパイラ・フラグのハッシュをキーにキャッシュする
+class NativeBuilder {
+private:
+    std::string compiler;  // C++コンパイラ（環境変数CXX、既定はc++）
+    std::string flags;     // コンパイルフラグ（既定値に環境変数CXXFLAGSを追加）
+    std::string cacheDir;  // キャッシュの置き場所
+    bool verbose = false;
+    size_t mapWindowSize = 0; // メモリマップのウィンドウの要素数（0ならランタイムの既定）
+
+    // キャッシュの置き場所（SIGNUM_CACHE_DIR → XDG_CACHE_HOME/signum → HOME/.cache/signum）
+    static std::string defaultCacheDir();
+    // 内容のハッシュ（FNV-1a 64bit）
+    static uint64_t hash(const std::string& data, uint64_t seed = 14695981039346656037ULL);
+    // シェルに渡す引数のクオート
+    static std::string shellQuote(const std::string& arg);
+
+    // ソースをコンパイルしてキャッシュに置く
+    void compile(const std::string& source, const std::string& binary);
+
+public:
+    NativeBuilder();
+
+    void setVerbose(bool enabled) { verbose = enabled; }
+    void setMapWindowSize(size_t size) { mapWindowSize = size; }
+    const std::string& getCacheDir() const { return cacheDir; }
+
+    // プログラムを実行ファイルにする（キャッシュがあれば再利用する）
+    void build(const std::shared_ptr<ASTNode>& program, const std::string& output);
+};
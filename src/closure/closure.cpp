@@ -0,0 +1,624 @@
+// SigNum Closure Compiler
+
+#include "closure.hpp"
+#include "../native/native.hpp"
+
+// 添字が静的な単純参照か
+static bool isStaticSlot(const std::shared_ptr<ASTNode>& node, char type) {
+    const MemoryDescriptor& mem = node->memory;
+    return node->type == NodeType::MemoryRef && mem.valid && !mem.isMap && mem.type == type &&
+           mem.indirection.empty() && mem.index >= 0 && mem.index < static_cast<int>(MEMORY_POOL_SIZE);
+}
+
+// int定数として読めるか
+static bool intConstant(const std::shared_ptr<ASTNode>& node, int& value) {
+    if (!node->constant || !std::holds_alternative<int>(*node->constant)) {
+        return false;
+    }
+    value = std::get<int>(*node->constant);
+    return true;
+}
+
+// プログラム全体をコンパイル
+Action ClosureCompiler::compile(const std::shared_ptr<ASTNode>& program) {
+    root = program;
+    functionSlots.clear();
+    return compileStatement(program);
+}
+
+// 関数の表はそのまま使う
+Action ClosureCompiler::compileNext(const std::shared_ptr<ASTNode>& statements) {
+    return compileStatement(statements);
+}
+
+// 関数本体の格納先
+std::shared_ptr<Action> ClosureCompiler::functionSlot(int id) {
+    auto& slot = functionSlots[id];
+    if (!slot) {
+        slot = std::make_shared<Action>();
+    }
+    return slot;
+}
+
+// 添字が静的なintプールの要素
+int* ClosureCompiler::intSlot(const std::shared_ptr<ASTNode>& node) {
+    if (!isStaticSlot(node, '#')) {
+        return nullptr;
+    }
+    return &interpreter.intPool[node->memory.index];
+}
+
+// 文のコンパイル
+Action ClosureCompiler::compileStatement(const std::shared_ptr<ASTNode>& node) {
+    switch (node->type) {
+        case NodeType::Program:
+        case NodeType::Statement: {
+            std::vector<Action> actions;
+            for (const auto& child : node->children) {
+                actions.push_back(compileStatement(child));
+            }
+            if (actions.size() == 1) {
+                return actions[0];
+            }
+            return [actions]() {
+                for (const Action& action : actions) {
+                    action();
+                }
+            };
+        }
+
+        case NodeType::Function: {
+            std::vector<Action> body;
+            for (const auto& child : node->children) {
+                body.push_back(compileStatement(child));
+            }
+            int id = std::stoi(node->value);
+            auto slot = functionSlot(id);
+            Interpreter& machine = interpreter;
+            return [slot, body, id, node, &machine]() {
+                *slot = [body]() {
+                    for (const Action& action : body) {
+                        action();
+                    }
+                };
+                // スナップショット用に関数テーブルにも残す
+                machine.functions[id] = node;
+                ++machine.functionsVersion;
+            };
+        }
+
+        case NodeType::FunctionCall: {
+            int id = std::stoi(node->value);
+            if (NativeRegistry::find(id)) {
+                Interpreter& machine = interpreter;
+                return [id, &machine]() {
+                    const NativeFunction* native = NativeRegistry::find(id);
+                    if (!native) {
+                        throw std::runtime_error("Function not found: " + std::to_string(id));
+                    }
+                    (*native)(machine);
+                };
+            }
+            auto slot = functionSlot(id);
+            std::string name = node->value;
+            return [slot, name]() {
+                if (!*slot) {
+                    throw std::runtime_error("Function not found: " + name);
+                }
+                (*slot)();
+            };
+        }
+
+        case NodeType::Assignment:
+            return compileAssignment(node);
+
+        case NodeType::IfStatement:
+            return compileIfStatement(node);
+
+        case NodeType::LoopStatement:
+            return compileLoopStatement(node);
+
+        case NodeType::OutputStatement: {
+            OutputWriter* output = &interpreter.output;
+            if (node->children.empty()) {
+                return [output]() { output->flush(); };
+            }
+            if (IntThunk value = compileInt(node->children[0])) {
+                return [value, output]() {
+                    output->write(value());
+                    output->endLine();
+                };
+            }
+            Thunk value = compileExpression(node->children[0]);
+            Interpreter* target = &interpreter;
+            return [value, target]() { target->writeLine(value()); };
+        }
+
+        case NodeType::StackOperation: {
+            Thunk operation = compileStackOperation(node);
+            return [operation]() { operation(); };
+        }
+
+        // 入出力やウィンドウスライドはツリーウォーカーに任せる
+        case NodeType::InputStatement:
+        case NodeType::FileInputStatement:
+        case NodeType::FileOutputStatement:
+        case NodeType::MapWindowSlide:
+        case NodeType::Error:
+            break;
+
+        // 式文
+        default: {
+            Thunk value = compileExpression(node);
+            return [value]() { value(); };
+        }
+    }
+
+    Interpreter& interp = interpreter;
+    return [&interp, node]() { interp.evaluateNode(node); };
+}
+
+// 代入のコンパイル
+Action ClosureCompiler::compileAssignment(const std::shared_ptr<ASTNode>& node) {
+    Interpreter& interp = interpreter;
+    if (node->children.size() < 2 || !node->children[0]->memory.valid) {
+        return [&interp, node]() { interp.evaluateNode(node); };
+    }
+
+    const auto& target = node->children[0];
+    const auto& source = node->children[1];
+    const MemoryDescriptor* mem = &target->memory;
+
+    // 複合代入（右辺は 左辺 op 式 の形）
+    bool compound = node->op != Operator::None && source->type == NodeType::ArithmeticExpression &&
+                    source->children.size() == 2;
+
+    // intプールの要素への代入
+    if (int* slot = intSlot(target)) {
+        if (IntThunk value = compileInt(source)) {
+            // 自己加算・減算（$#n = $#n ± 定数、$#n += 定数）
+            int constant;
+            if (source->type == NodeType::ArithmeticExpression && source->children.size() == 2 &&
+                intSlot(source->children[0]) == slot && intConstant(source->children[1], constant)) {
+                if (source->op == Operator::Add) {
+                    return [slot, constant]() { *slot += constant; };
+                }
+                if (source->op == Operator::Subtract) {
+                    return [slot, constant]() { *slot -= constant; };
+                }
+            }
+            if (compound) {
+                IntThunk operand = compileInt(source->children[1]);
+                switch (node->op) {
+                    case Operator::Add: return [slot, operand]() { *slot += operand(); };
+                    case Operator::Subtract: return [slot, operand]() { *slot -= operand(); };
+                    case Operator::Multiply: return [slot, operand]() { *slot *= operand(); };
+                    default: break;
+                }
+            }
+            return [slot, value]() { *slot = value(); };
+        }
+    }
+    // 文字列の連結は既存の文字列に追記する
+    else if (compound && node->op == Operator::Add && isStaticSlot(target, '@')) {
+        std::string* slot = &interp.stringPool[mem->index];
+        Thunk operand = compileExpression(source->children[1]);
+        return [slot, operand]() {
+            Value value = operand();
+            if (const std::string* str = std::get_if<std::string>(&value)) {
+                *slot += *str;
+            } else {
+                *slot += Interpreter::valueToString(value);
+            }
+        };
+    }
+    // boolプールの要素への代入
+    else if (isStaticSlot(target, '%')) {
+        if (BoolThunk value = compileBool(source)) {
+            int index = mem->index;
+            return [&interp, index, value]() { interp.boolPool[index] = value(); };
+        }
+    }
+
+    Thunk value = compileExpression(source);
+    if (mem->isMap) {
+        return [&interp, mem, value]() {
+            Value result = value();
+            interp.writeMemoryMap(mem->type, interp.resolveMemoryIndex(*mem), result);
+        };
+    }
+    return [&interp, mem, value]() {
+        Value result = value();
+        interp.setMemoryValue(mem->type, interp.resolveMemoryIndex(*mem), result);
+    };
+}
+
+// 条件分岐のコンパイル
+Action ClosureCompiler::compileIfStatement(const std::shared_ptr<ASTNode>& node) {
+    const auto& children = node->children;
+    if (children.size() < 2) {
+        Interpreter& interp = interpreter;
+        return [&interp, node]() { interp.evaluateNode(node); };
+    }
+
+    // 条件と本体の組（2つ置きに条件と本体、最後の1つはelse）
+    std::vector<std::pair<BoolThunk, Action>> branches;
+    Action otherwise;
+    branches.emplace_back(compileIfCondition(children[0]), compileStatement(children[1]));
+    for (size_t i = 2; i < children.size(); i += 2) {
+        if (i == children.size() - 1) {
+            otherwise = compileStatement(children[i]);
+            break;
+        }
+        branches.emplace_back(compileIfCondition(children[i]), compileStatement(children[i + 1]));
+    }
+
+    if (branches.size() == 1 && !otherwise) {
+        BoolThunk condition = branches[0].first;
+        Action body = branches[0].second;
+        return [condition, body]() {
+            if (condition()) body();
+        };
+    }
+    return [branches, otherwise]() {
+        for (const auto& branch : branches) {
+            if (branch.first()) {
+                branch.second();
+                return;
+            }
+        }
+        if (otherwise) otherwise();
+    };
+}
+
+// ループのコンパイル
+Action ClosureCompiler::compileLoopStatement(const std::shared_ptr<ASTNode>& node) {
+    if (node->children.size() < 2) {
+        Interpreter& interp = interpreter;
+        return [&interp, node]() { interp.evaluateNode(node); };
+    }
+
+    BoolThunk condition = compileLoopCondition(node->children[0]);
+    Action body = compileStatement(node->children[1]);
+    return [condition, body]() {
+        while (condition()) {
+            body();
+        }
+    };
+}
+
+// 条件分岐の条件：trueのときだけ本体に入る
+BoolThunk ClosureCompiler::compileIfCondition(const std::shared_ptr<ASTNode>& node) {
+    if (BoolThunk condition = compileBool(node)) {
+        return condition;
+    }
+    Thunk value = compileExpression(node);
+    return [value]() {
+        Value result = value();
+        const bool* condition = std::get_if<bool>(&result);
+        return condition && *condition;
+    };
+}
+
+// ループの条件：falseのときだけ抜ける
+BoolThunk ClosureCompiler::compileLoopCondition(const std::shared_ptr<ASTNode>& node) {
+    if (BoolThunk condition = compileBool(node)) {
+        return condition;
+    }
+    Thunk value = compileExpression(node);
+    return [value]() {
+        Value result = value();
+        const bool* condition = std::get_if<bool>(&result);
+        return !(condition && !*condition);
+    };
+}
+
+// int式のコンパイル
+IntThunk ClosureCompiler::compileInt(const std::shared_ptr<ASTNode>& node) {
+    switch (node->type) {
+        case NodeType::Number:
+        case NodeType::Constant: {
+            int value;
+            if (!intConstant(node, value)) {
+                return nullptr;
+            }
+            return [value]() { return value; };
+        }
+
+        case NodeType::MemoryRef: {
+            if (int* slot = intSlot(node)) {
+                return [slot]() { return *slot; };
+            }
+            // ネストされた参照
+            const MemoryDescriptor* mem = &node->memory;
+            if (!mem->valid || mem->isMap || mem->type != '#') {
+                return nullptr;
+            }
+            Interpreter& interp = interpreter;
+            return [&interp, mem]() { return interp.getInt(interp.resolveMemoryIndex(*mem)); };
+        }
+
+        case NodeType::ArithmeticExpression: {
+            if (node->children.size() == 1) {
+                return compileInt(node->children[0]);
+            }
+            if (node->children.size() != 2) {
+                return nullptr;
+            }
+
+            // 要素と定数の演算
+            int* slot = intSlot(node->children[0]);
+            int constant;
+            if (slot && intConstant(node->children[1], constant)) {
+                switch (node->op) {
+                    case Operator::Add: return [slot, constant]() { return *slot + constant; };
+                    case Operator::Subtract: return [slot, constant]() { return *slot - constant; };
+                    case Operator::Multiply: return [slot, constant]() { return *slot * constant; };
+                    case Operator::Modulus:
+                        if (constant != 0) return [slot, constant]() { return *slot % constant; };
+                        break;
+                    default: break;
+                }
+            }
+
+            IntThunk left = compileInt(node->children[0]);
+            IntThunk right = compileInt(node->children[1]);
+            if (!left || !right) {
+                return nullptr;
+            }
+            switch (node->op) {
+                case Operator::Add: return [left, right]() { return left() + right(); };
+                case Operator::Subtract: return [left, right]() { return left() - right(); };
+                case Operator::Multiply: return [left, right]() { return left() * right(); };
+                case Operator::Divide:
+                    return [left, right]() {
+                        int lval = left();
+                        int rval = right();
+                        if (rval == 0) throw std::runtime_error("Division by zero");
+                        return lval / rval;
+                    };
+                case Operator::Modulus:
+                    return [left, right]() {
+                        int lval = left();
+                        int rval = right();
+                        if (rval == 0) throw std::runtime_error("Modulo by zero");
+                        return lval % rval;
+                    };
+                default: return nullptr;
+            }
+        }
+
+        default:
+            return nullptr;
+    }
+}
+
+// bool式のコンパイル
+BoolThunk ClosureCompiler::compileBool(const std::shared_ptr<ASTNode>& node) {
+    switch (node->type) {
+        case NodeType::Constant: {
+            if (!node->constant || !std::holds_alternative<bool>(*node->constant)) {
+                return nullptr;
+            }
+            bool value = std::get<bool>(*node->constant);
+            return [value]() { return value; };
+        }
+
+        case NodeType::MemoryRef: {
+            if (!isStaticSlot(node, '%')) {
+                return nullptr;
+            }
+            Interpreter& interp = interpreter;
+            int index = node->memory.index;
+            return [&interp, index]() -> bool { return interp.boolPool[index]; };
+        }
+
+        case NodeType::Comparison: {
+            if (node->children.size() != 2) {
+                return nullptr;
+            }
+
+            // 要素と定数の比較
+            int* slot = intSlot(node->children[0]);
+            int constant;
+            if (slot && intConstant(node->children[1], constant)) {
+                switch (node->op) {
+                    case Operator::Equal: return [slot, constant]() { return *slot == constant; };
+                    case Operator::NotEqual: return [slot, constant]() { return *slot != constant; };
+                    case Operator::Less: return [slot, constant]() { return *slot < constant; };
+                    case Operator::LessEqual: return [slot, constant]() { return *slot <= constant; };
+                    case Operator::Greater: return [slot, constant]() { return *slot > constant; };
+                    case Operator::GreaterEqual: return [slot, constant]() { return *slot >= constant; };
+                    default: break;
+                }
+            }
+
+            IntThunk left = compileInt(node->children[0]);
+            IntThunk right = compileInt(node->children[1]);
+            if (!left || !right) {
+                return nullptr;
+            }
+            switch (node->op) {
+                case Operator::Equal: return [left, right]() { return left() == right(); };
+                case Operator::NotEqual: return [left, right]() { return left() != right(); };
+                case Operator::Less: return [left, right]() { return left() < right(); };
+                case Operator::LessEqual: return [left, right]() { return left() <= right(); };
+                case Operator::Greater: return [left, right]() { return left() > right(); };
+                case Operator::GreaterEqual: return [left, right]() { return left() >= right(); };
+                default: return nullptr;
+            }
+        }
+
+        case NodeType::LogicalExpression: {
+            if (node->children.size() == 1) {
+                BoolThunk operand = compileBool(node->children[0]);
+                if (!operand) {
+                    return nullptr;
+                }
+                if (node->op == Operator::Not) {
+                    return [operand]() { return !operand(); };
+                }
+                return operand;
+            }
+            if (node->children.size() != 2) {
+                return nullptr;
+            }
+            BoolThunk left = compileBool(node->children[0]);
+            BoolThunk right = compileBool(node->children[1]);
+            if (!left || !right) {
+                return nullptr;
+            }
+            // ツリーウォーカーと同じく両辺とも評価する
+            switch (node->op) {
+                case Operator::And:
+                    return [left, right]() {
+                        bool lval = left();
+                        bool rval = right();
+                        return lval && rval;
+                    };
+                case Operator::Or:
+                    return [left, right]() {
+                        bool lval = left();
+                        bool rval = right();
+                        return lval || rval;
+                    };
+                default: return nullptr;
+            }
+        }
+
+        default:
+            return nullptr;
+    }
+}
+
+// 式のコンパイル
+Thunk ClosureCompiler::compileExpression(const std::shared_ptr<ASTNode>& node) {
+    if (IntThunk value = compileInt(node)) {
+        return [value]() { return Value(value()); };
+    }
+    if (BoolThunk value = compileBool(node)) {
+        return [value]() { return Value(value()); };
+    }
+
+    Interpreter& interp = interpreter;
+    switch (node->type) {
+        // リテラル・定数
+        case NodeType::Number:
+        case NodeType::String:
+        case NodeType::Constant: {
+            if (!node->constant) {
+                break;
+            }
+            Value value = *node->constant;
+            return [value]() { return value; };
+        }
+
+        case NodeType::MemoryRef:
+        case NodeType::MemoryMapRef: {
+            const MemoryDescriptor* mem = &node->memory;
+            if (!mem->valid) {
+                break;
+            }
+            if (mem->isMap) {
+                return [&interp, mem]() { return interp.readMemoryMap(mem->type, interp.resolveMemoryIndex(*mem)); };
+            }
+            return [&interp, mem]() { return interp.getMemoryValue(mem->type, interp.resolveMemoryIndex(*mem)); };
+        }
+
+        case NodeType::ArithmeticExpression: {
+            if (node->children.size() == 1) {
+                return compileExpression(node->children[0]);
+            }
+            if (node->children.size() != 2) {
+                break;
+            }
+            Thunk left = compileExpression(node->children[0]);
+            Thunk right = compileExpression(node->children[1]);
+            Operator op = node->op;
+            return [left, right, op]() {
+                Value lval = left();
+                Value rval = right();
+                return Interpreter::applyArithmetic(op, lval, rval);
+            };
+        }
+
+        case NodeType::Comparison: {
+            if (node->children.size() != 2) {
+                break;
+            }
+            Thunk left = compileExpression(node->children[0]);
+            Thunk right = compileExpression(node->children[1]);
+            Operator op = node->op;
+            return [left, right, op]() {
+                Value lval = left();
+                Value rval = right();
+                return Interpreter::applyComparison(op, lval, rval);
+            };
+        }
+
+        case NodeType::Cast: {
+            if (node->children.empty()) {
+                break;
+            }
+            Thunk operand = compileExpression(node->children[0]);
+            Operator op = node->op;
+            return [operand, op]() { return Interpreter::applyCast(op, operand()); };
+        }
+
+        case NodeType::CharCodeCast: {
+            if (node->children.empty()) {
+                break;
+            }
+            Thunk operand = compileExpression(node->children[0]);
+            Operator op = node->op;
+            return [operand, op]() { return Interpreter::applyCharCodeCast(op, operand()); };
+        }
+
+        case NodeType::StackOperation:
+            return compileStackOperation(node);
+
+        default:
+            break;
+    }
+    return compileFallback(node);
+}
+
+// スタック操作のコンパイル
+Thunk ClosureCompiler::compileStackOperation(const std::shared_ptr<ASTNode>& node) {
+    char type = '\0';
+    bool push = false;
+    switch (node->op) {
+        case Operator::IntegerStackPush: type = '#'; push = true; break;
+        case Operator::IntegerStackPop: type = '#'; break;
+        case Operator::FloatStackPush: type = '~'; push = true; break;
+        case Operator::FloatStackPop: type = '~'; break;
+        case Operator::StringStackPush: type = '@'; push = true; break;
+        case Operator::StringStackPop: type = '@'; break;
+        case Operator::BooleanStackPush: type = '%'; push = true; break;
+        case Operator::BooleanStackPop: type = '%'; break;
+        default: break;
+    }
+    if (type == '\0' || node->children.empty()) {
+        return compileFallback(node);
+    }
+
+    Interpreter& interp = interpreter;
+    Thunk operand = compileExpression(node->children[0]);
+    if (push) {
+        return [&interp, operand, type]() {
+            interp.pushStack(type, operand());
+            return Value();
+        };
+    }
+    // ポップ対象の式は評価だけして捨てる
+    return [&interp, operand, type]() {
+        operand();
+        return interp.popStack(type);
+    };
+}
+
+// ツリーウォーカーに委譲
+Thunk ClosureCompiler::compileFallback(const std::shared_ptr<ASTNode>& node) {
+    Interpreter& interp = interpreter;
+    return [&interp, node]() { return interp.evaluateNode(node); };
+}
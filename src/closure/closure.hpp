@@ -0,0 +1,59 @@
+// SigNum Closure Compiler
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "../interpreter/interpreter.hpp"
+
+// 事前にバインドされた文・式
+using Action = std::function<void()>;
+using Thunk = std::function<Value()>;
+using IntThunk = std::function<int()>;
+using BoolThunk = std::function<bool()>;
+
+// ASTをクロージャの木に変換して実行するエンジン
+// メモリプール・スタック・メモリマップはInterpreterのものをそのまま使う
+class ClosureCompiler {
+private:
+    Interpreter& interpreter;
+    std::shared_ptr<ASTNode> root; // クロージャが参照するノードを保持
+
+    // 関数ID → 本体（定義文の実行時に設定される）
+    std::unordered_map<int, std::shared_ptr<Action>> functionSlots;
+    std::shared_ptr<Action> functionSlot(int id);
+
+    // 文のコンパイル
+    Action compileStatement(const std::shared_ptr<ASTNode>& node);
+    Action compileAssignment(const std::shared_ptr<ASTNode>& node);
+    Action compileIfStatement(const std::shared_ptr<ASTNode>& node);
+    Action compileLoopStatement(const std::shared_ptr<ASTNode>& node);
+
+    // 式のコンパイル
+    Thunk compileExpression(const std::shared_ptr<ASTNode>& node);
+    Thunk compileStackOperation(const std::shared_ptr<ASTNode>& node);
+
+    // 型が静的に分かる式のコンパイル（できなければ空を返す）
+    IntThunk compileInt(const std::shared_ptr<ASTNode>& node);
+    BoolThunk compileBool(const std::shared_ptr<ASTNode>& node);
+
+    // 条件式（trueのときだけ成立 / falseのときだけ不成立）
+    BoolThunk compileIfCondition(const std::shared_ptr<ASTNode>& node);
+    BoolThunk compileLoopCondition(const std::shared_ptr<ASTNode>& node);
+
+    // 添字が静的なメモリプールの要素
+    int* intSlot(const std::shared_ptr<ASTNode>& node);
+
+    // ツリーウォーカーに委譲
+    Thunk compileFallback(const std::shared_ptr<ASTNode>& node);
+
+public:
+    ClosureCompiler(Interpreter& interpreter) : interpreter(interpreter) {}
+
+    // プログラム全体をコンパイル
+    Action compile(const std::shared_ptr<ASTNode>& program);
+    // 直前にコンパイルしたプログラムの関数を呼ぶ、続きの文をコンパイル（ノードは直前のプログラムの一部）
+    Action compileNext(const std::shared_ptr<ASTNode>& statements);
+};
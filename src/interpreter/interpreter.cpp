@@ -1,112 +1,386 @@
 // SigNum Interpreter
 
+#include <algorithm>
+#include <charconv>
 #include <cstdint>
+#include <cstring>
+#include <limits>
+#include <map>
 #include "interpreter.hpp"
+#include "../native/native.hpp"
+
+// POSIX環境ではメモリマップをファイルの mmap で実装する（それ以外は読み書きのたびにファイルを開く）
+#if defined(__unix__) || defined(__APPLE__)
+#define SIGNUM_MMAP_SUPPORTED 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// PageBitmapクラス
+// firstPage〜lastPage に印を付ける
+void PageBitmap::mark(size_t firstPage, size_t lastPage) {
+    size_t begin = firstPage / 64;
+    size_t end = lastPage / 64 + 1;
+    if (words.size() < end) {
+        words.resize(end);
+    }
+    first = empty() ? begin : std::min(first, begin);
+    last = std::max(last, end);
+    for (size_t page = firstPage; page <= lastPage; ++page) {
+        words[page / 64] |= uint64_t(1) << (page % 64);
+    }
+}
+
+// 別のビットマップの印を加える
+void PageBitmap::merge(const PageBitmap& other) {
+    if (other.empty()) {
+        return;
+    }
+    if (words.size() < other.last) {
+        words.resize(other.last);
+    }
+    for (size_t i = other.first; i < other.last; ++i) {
+        words[i] |= other.words[i];
+    }
+    first = empty() ? other.first : std::min(first, other.first);
+    last = std::max(last, other.last);
+}
+
+// 印をすべて消す（確保した語は使い回す）
+void PageBitmap::clear() {
+    std::fill(words.begin() + static_cast<std::ptrdiff_t>(first), words.begin() + static_cast<std::ptrdiff_t>(last), 0);
+    first = 0;
+    last = 0;
+}
 
 // MemoryMapクラス
+// 要素の位置を表せるファイルのオフセットの上限
+constexpr size_t MEMORY_MAP_MAX_OFFSET = static_cast<size_t>(std::numeric_limits<std::streamoff>::max());
+
+MemoryMap::MemoryMap(MemoryMap&& other) noexcept
+    : filePath(std::move(other.filePath)), windowOffset(other.windowOffset), windowSize(other.windowSize),
+      mapType(other.mapType),
+      fd(other.fd), data(other.data), mappedSize(other.mappedSize), fileSize(other.fileSize),
+      dirtyPages(std::move(other.dirtyPages)), flushingPages(std::move(other.flushingPages)) {
+    other.filePath.clear();
+    other.fd = -1;
+    other.data = nullptr;
+    other.mappedSize = 0;
+    other.fileSize = 0;
+    other.dirtyPages = PageBitmap();
+    other.flushingPages = PageBitmap();
+}
+
+MemoryMap& MemoryMap::operator=(MemoryMap&& other) noexcept {
+    if (this != &other) {
+        close();
+        filePath = std::move(other.filePath);
+        windowOffset = other.windowOffset;
+        windowSize = other.windowSize;
+        mapType = other.mapType;
+        fd = other.fd;
+        data = other.data;
+        mappedSize = other.mappedSize;
+        fileSize = other.fileSize;
+        dirtyPages = std::move(other.dirtyPages);
+        flushingPages = std::move(other.flushingPages);
+        other.filePath.clear();
+        other.fd = -1;
+        other.data = nullptr;
+        other.mappedSize = 0;
+        other.fileSize = 0;
+        other.dirtyPages = PageBitmap();
+        other.flushingPages = PageBitmap();
+    }
+    return *this;
+}
+
 // ファイルマッピング
 void MemoryMap::mapFile(const std::string& path, char type) {
+    close();
     filePath = path;
     mapType = type;
     windowOffset = 0;
+    open();
+}
+
+// 保存しておいた状態に戻す
+void MemoryMap::restore(const std::string& path, char type, size_t offset) {
+    close();
+    filePath = path;
+    mapType = type;
+    windowOffset = offset;
+    if (!filePath.empty()) {
+        open();
+    }
+}
+
+#ifdef SIGNUM_MMAP_SUPPORTED
+
+// 伸ばすときに作り直さずに済むよう、マッピングはこの大きさ単位で確保する
+constexpr size_t MEMORY_MAP_RESERVE = 1 << 20;
+
+// 書き込みを記録するページの大きさ（msync の単位）
+static const size_t MEMORY_PAGE_SIZE = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+// ファイルを開いてマップする
+void MemoryMap::open() {
+    elementSize(); // 型の検査
+    fd = ::open(filePath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        std::string path = filePath;
+        filePath.clear();
+        throw std::runtime_error("Failed to create/extend file: " + path);
+    }
     ensureFileSize();
+    remap();
+}
+
+// マッピングを解除してファイルを閉じる
+void MemoryMap::close() {
+    if (data) {
+        sync(false);
+        munmap(data, mappedSize);
+        data = nullptr;
+    }
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    mappedSize = 0;
+    fileSize = 0;
+    dirtyPages.clear();
+    flushingPages.clear();
+}
+
+// 現在のファイルサイズに合わせてマップし直す
+void MemoryMap::remap() {
+    struct stat status;
+    if (fstat(fd, &status) != 0) {
+        throw std::runtime_error("Failed to stat file: " + filePath);
+    }
+    fileSize = static_cast<size_t>(status.st_size);
+    if (data && fileSize <= mappedSize) {
+        return;
+    }
+    size_t previousSize = mappedSize;
+    if (data) {
+        munmap(data, mappedSize);
+        data = nullptr;
+        mappedSize = 0;
+    }
+    if (fileSize == 0) {
+        return;
+    }
+    // ファイルより大きく確保しておく（終端より先のページには触れない）
+    // 書き足して伸ばすときは前の倍まで取り、大きなファイルでも作り直しは数回で済ませる
+    size_t size = (fileSize + MEMORY_MAP_RESERVE - 1) / MEMORY_MAP_RESERVE * MEMORY_MAP_RESERVE;
+    if (previousSize > 0 && size < previousSize * 2) {
+        size = previousSize * 2;
+    }
+    void* address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED) {
+        throw std::runtime_error("Failed to map file: " + filePath);
+    }
+    data = static_cast<char*>(address);
+    mappedSize = size;
+}
+
+// ファイルが外から書き換えられたときにマップし直す（縮んだときは作り直す）
+void MemoryMap::reload() {
+    if (fd < 0) {
+        return;
+    }
+    if (data) {
+        sync(false);
+        munmap(data, mappedSize);
+        data = nullptr;
+        mappedSize = 0;
+    }
+    remap();
 }
 
-// ファイルサイズの確保・拡張
+// ファイルサイズの確保・拡張（ウィンドウ1つ分に満たなければゼロで埋める）
 void MemoryMap::ensureFileSize() {
-    std::ifstream checkFile(filePath, std::ios::binary | std::ios::ate);
-    size_t currentSize = 0;
-    
-    if (checkFile.is_open()) {
-        currentSize = checkFile.tellg();
-        checkFile.close();
+    struct stat status;
+    if (fstat(fd, &status) != 0) {
+        throw std::runtime_error("Failed to stat file: " + filePath);
     }
-    
-    // 必要なサイズを計算
-    size_t elementSize;
-    switch (mapType) {
-        case '#': case '~': elementSize = 4; break; // int, float
-        case '%': elementSize = 1; break; // bool
-        case '@': elementSize = 1; break; // string (char配列)
-        default: throw std::runtime_error("Unknown map type for size calculation");
+    size_t requiredSize = windowSize * elementSize();
+    if (static_cast<size_t>(status.st_size) < requiredSize && ftruncate(fd, static_cast<off_t>(requiredSize)) != 0) {
+        throw std::runtime_error("Failed to create/extend file: " + filePath);
     }
-    
-    size_t requiredSize = MEMORY_MAP_SIZE * elementSize;
-    
-    // ファイルサイズが不足している場合は拡張
-    if (currentSize < requiredSize) {
+}
+
+// ファイルの offset から size バイトを読む
+void MemoryMap::readBytes(size_t offset, size_t size, void* out) const {
+    size_t available = offset < fileSize ? std::min(size, fileSize - offset) : 0;
+    if (available > 0) {
+        std::memcpy(out, data + offset, available);
+    }
+    std::memset(static_cast<char*>(out) + available, 0, size - available);
+}
+
+// ファイルの offset から size バイトを書く
+void MemoryMap::writeBytes(size_t offset, size_t size, const void* in) {
+    size_t end = offset + size;
+    if (end > fileSize) {
+        if (ftruncate(fd, static_cast<off_t>(end)) != 0) {
+            throw std::runtime_error("Failed to create/extend file: " + filePath);
+        }
+        remap();
+    }
+    std::memcpy(data + offset, in, size);
+    markDirty(offset, end);
+}
+
+// ファイルの [offset, end) を含むページに書き込みの印を付ける
+void MemoryMap::markDirty(size_t offset, size_t end) {
+    dirtyPages.mark(offset / MEMORY_PAGE_SIZE, (end - 1) / MEMORY_PAGE_SIZE);
+}
+
+// 印の付いたページを連続した範囲ごとに msync する（ファイルの終端を含むページまで）
+bool MemoryMap::flushPages(const PageBitmap& pages, int flags) {
+    bool succeeded = true;
+    pages.forEachRun((fileSize + MEMORY_PAGE_SIZE - 1) / MEMORY_PAGE_SIZE, [&](size_t page, size_t count) {
+        if (msync(data + page * MEMORY_PAGE_SIZE, count * MEMORY_PAGE_SIZE, flags) != 0) {
+            succeeded = false;
+        }
+    });
+    return succeeded;
+}
+
+// 書き込んだ内容をファイルに反映する
+void MemoryMap::sync(bool wait) {
+    if (!data || (dirtyPages.empty() && (!wait || flushingPages.empty()))) {
+        return;
+    }
+    // 書き込んだページは反映を始めたページとして覚えておく
+    flushingPages.merge(dirtyPages);
+    bool succeeded = wait ? flushPages(flushingPages, MS_SYNC) : flushPages(dirtyPages, MS_ASYNC);
+    dirtyPages.clear();
+    if (wait) {
+        flushingPages.clear();
+        if (!succeeded) {
+            throw std::runtime_error("Failed to sync memory map: " + filePath);
+        }
+    }
+}
+
+#else
+
+// mmap のない環境では要素の読み書きのたびにファイルを開いて読み書きする
+
+// ファイルを開く（なければ作る）
+void MemoryMap::open() {
+    elementSize(); // 型の検査
+    std::ofstream create(filePath, std::ios::binary | std::ios::app);
+    if (!create) {
+        std::string path = filePath;
+        filePath.clear();
+        throw std::runtime_error("Failed to create/extend file: " + path);
+    }
+    create.close();
+    ensureFileSize();
+    remap();
+}
+
+// ファイルを閉じる（書き込みは済んでいる）
+void MemoryMap::close() {
+    fileSize = 0;
+}
+
+// 現在のファイルサイズを調べ直す
+void MemoryMap::remap() {
+    std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+    if (!file) {
+        throw std::runtime_error("Failed to stat file: " + filePath);
+    }
+    fileSize = static_cast<size_t>(file.tellg());
+}
+
+// ファイルが外から書き換えられたときにサイズを調べ直す
+void MemoryMap::reload() {
+    if (isMapped()) {
+        remap();
+    }
+}
+
+// ファイルサイズの確保・拡張（ウィンドウ1つ分に満たなければゼロで埋める）
+void MemoryMap::ensureFileSize() {
+    remap();
+    size_t requiredSize = windowSize * elementSize();
+    if (fileSize < requiredSize) {
         std::ofstream file(filePath, std::ios::binary | std::ios::app);
-        if (!file) {
+        std::vector<char> padding(requiredSize - fileSize, 0);
+        if (!file || !file.write(padding.data(), static_cast<std::streamsize>(padding.size()))) {
             throw std::runtime_error("Failed to create/extend file: " + filePath);
         }
-        
-        // 不足分をゼロパディング
-        size_t paddingSize = requiredSize - currentSize;
-        std::vector<char> padding(paddingSize, 0);
-        file.write(padding.data(), paddingSize);
-        file.close();
+        fileSize = requiredSize;
     }
 }
 
-// 要素の読み取り
-Value MemoryMap::readElement(size_t index) {
-    if (index >= MEMORY_MAP_SIZE) {
-        throw std::out_of_range("Memory map index out of range: " + std::to_string(index));
+// ファイルの offset から size バイトを読む
+void MemoryMap::readBytes(size_t offset, size_t size, void* out) const {
+    size_t available = offset < fileSize ? std::min(size, fileSize - offset) : 0;
+    if (available > 0) {
+        std::ifstream file(filePath, std::ios::binary);
+        if (!file || !file.seekg(static_cast<std::streamoff>(offset)) ||
+            !file.read(static_cast<char*>(out), static_cast<std::streamsize>(available))) {
+            throw std::runtime_error("Failed to open file for reading: " + filePath);
+        }
     }
-    
-    std::ifstream file(filePath, std::ios::binary);
+    std::memset(static_cast<char*>(out) + available, 0, size - available);
+}
+
+// ファイルの offset から size バイトを書く（終端より先なら伸ばす）
+void MemoryMap::writeBytes(size_t offset, size_t size, const void* in) {
+    std::fstream file(filePath, std::ios::binary | std::ios::in | std::ios::out);
     if (!file) {
-        throw std::runtime_error("Failed to open file for reading: " + filePath);
+        throw std::runtime_error("Failed to open file for writing: " + filePath);
     }
-    
-    size_t elementSize;
-    size_t fileOffset;
-    
+    // 終端より先へ移動して書けば、間はゼロで埋まる
+    if (!file.seekp(static_cast<std::streamoff>(offset)) || !file.write(static_cast<const char*>(in), static_cast<std::streamsize>(size)) || !file.flush()) {
+        throw std::runtime_error("Failed to open file for writing: " + filePath);
+    }
+    fileSize = std::max(fileSize, offset + size);
+}
+
+// 書き込みは要素ごとにファイルへ流しているので、ここでは何もしない
+void MemoryMap::sync(bool) {}
+
+#endif
+
+// 要素の読み取り（ファイルの終端より先は0）
+Value MemoryMap::readElement(size_t index) {
+    if (index >= windowSize) {
+        throw std::out_of_range("Memory map index out of range: " + std::to_string(index));
+    }
+    size_t offset = (windowOffset + index) * elementSize();
+
     switch (mapType) {
-        case '#': // int (4バイト)
-            elementSize = 4;
-            fileOffset = (windowOffset + index) * elementSize;
-            file.seekg(fileOffset);
-            {
-                int32_t value;
-                file.read(reinterpret_cast<char*>(&value), sizeof(value));
-                return static_cast<int>(value);
-            }
-            break;
-            
-        case '~': // float (4バイト)
-            elementSize = 4;
-            fileOffset = (windowOffset + index) * elementSize;
-            file.seekg(fileOffset);
-            {
-                float value;
-                file.read(reinterpret_cast<char*>(&value), sizeof(value));
-                return static_cast<double>(value);
-            }
-            break;
-            
-        case '%': // bool (1バイト)
-            elementSize = 1;
-            fileOffset = (windowOffset + index) * elementSize;
-            file.seekg(fileOffset);
-            {
-                uint8_t value;
-                file.read(reinterpret_cast<char*>(&value), sizeof(value));
-                return static_cast<bool>(value);
-            }
-            break;
-            
-        case '@': // string (UTF-8可変長)
-            elementSize = 1;
-            fileOffset = windowOffset + index;
-            file.seekg(fileOffset);
-            {
-                char value;
-                file.read(&value, 1);
-                return std::string(1, value);
-            }
-            break;
-            
+        case '#': { // int (4バイト)
+            int32_t value;
+            readBytes(offset, sizeof(value), &value);
+            return static_cast<int>(value);
+        }
+        case '~': { // float (4バイト)
+            float value;
+            readBytes(offset, sizeof(value), &value);
+            return static_cast<double>(value);
+        }
+        case '%': { // bool (1バイト)
+            char value;
+            readBytes(offset, 1, &value);
+            return value != 0;
+        }
+        case '@': { // string (UTF-8可変長)
+            char value;
+            readBytes(offset, 1, &value);
+            return std::string(1, value);
+        }
         default:
             throw std::runtime_error("Unknown memory map type: " + std::string(1, mapType));
     }
@@ -114,168 +388,139 @@ Value MemoryMap::readElement(size_t index) {
 
 // 要素の書き込み
 void MemoryMap::writeElement(size_t index, const Value& value) {
-    if (index >= MEMORY_MAP_SIZE) {
+    if (index >= windowSize) {
         throw std::out_of_range("Memory map index out of range: " + std::to_string(index));
     }
-    
-    std::fstream file(filePath, std::ios::binary | std::ios::in | std::ios::out);
-    if (!file) {
-        throw std::runtime_error("Failed to open file for writing: " + filePath);
-    }
-    
-    size_t elementSize;
-    size_t fileOffset;
-    
+    size_t offset = (windowOffset + index) * elementSize();
+
     switch (mapType) {
-        case '#': // int (4バイト)
-            elementSize = 4;
-            fileOffset = (windowOffset + index) * elementSize;
-            file.seekp(fileOffset);
-            {
-                int32_t intVal = std::get<int>(value);
-                file.write(reinterpret_cast<const char*>(&intVal), sizeof(intVal));
-            }
+        case '#': { // int (4バイト)
+            int32_t intVal = std::get<int>(value);
+            writeBytes(offset, sizeof(intVal), &intVal);
             break;
-            
-        case '~': // float (4バイト)
-            elementSize = 4;
-            fileOffset = (windowOffset + index) * elementSize;
-            file.seekp(fileOffset);
-            {
-                float floatVal = static_cast<float>(std::get<double>(value));
-                file.write(reinterpret_cast<const char*>(&floatVal), sizeof(floatVal));
-            }
+        }
+        case '~': { // float (4バイト)
+            float floatVal = static_cast<float>(std::get<double>(value));
+            writeBytes(offset, sizeof(floatVal), &floatVal);
             break;
-            
-        case '%': // bool (1バイト)
-            elementSize = 1;
-            fileOffset = (windowOffset + index) * elementSize;
-            file.seekp(fileOffset);
-            {
-                uint8_t boolVal = std::get<bool>(value) ? 1 : 0;
-                file.write(reinterpret_cast<const char*>(&boolVal), sizeof(boolVal));
-            }
+        }
+        case '%': { // bool (1バイト)
+            char boolVal = std::get<bool>(value) ? 1 : 0;
+            writeBytes(offset, 1, &boolVal);
             break;
-            
-        case '@': // string (UTF-8可変長)
-            elementSize = 1;
-            fileOffset = windowOffset + index;
-            file.seekp(fileOffset);
-            {
-                std::string strVal = std::get<std::string>(value);
-                if (!strVal.empty()) {
-                    file.write(&strVal[0], 1);
-                } 
-                else {
-                    char nullChar = '\0';
-                    file.write(&nullChar, 1);
-                }
-            }
+        }
+        case '@': { // string (UTF-8可変長)
+            const std::string& strVal = std::get<std::string>(value);
+            char charVal = strVal.empty() ? '\0' : strVal[0];
+            writeBytes(offset, 1, &charVal);
             break;
-            
+        }
         default:
             throw std::runtime_error("Unknown memory map type: " + std::string(1, mapType));
     }
-    
-    file.flush();
 }
 
-// ウィンドウスライド
-void MemoryMap::slideWindow(int offset) {
-    int newOffset = static_cast<int>(windowOffset) + offset;
-    
-    // 0未満にならないようにクランプ
-    if (newOffset < 0) {
-        windowOffset = 0;
-    } else {
-        windowOffset = static_cast<size_t>(newOffset);
+// 要素のバイト数
+size_t MemoryMap::elementSize() const {
+    switch (mapType) {
+        case '#': case '~': return 4; // int, float
+        case '%': case '@': return 1; // bool, string
+        default: throw std::runtime_error("Unknown memory map type: " + std::string(1, mapType));
     }
 }
 
+// 連続した要素をまとめて読み取り（ファイルの終端より先は0）
+void MemoryMap::readBlock(size_t index, size_t count, void* data) {
+    if (index > windowSize || count > windowSize - index) {
+        throw std::out_of_range("Memory map range out of range: " + std::to_string(index) + "+" + std::to_string(count));
+    }
+    readBytes((windowOffset + index) * elementSize(), count * elementSize(), data);
+}
 
-// メモリ参照を解決する
-Value Interpreter::resolveMemoryRef(const std::string& ref) {
-    int startPos = (ref[0] == '$') ? 1 : 0;
-    
-    // ネストされた参照チェック
-    size_t nextDollar = ref.find('$', startPos + 1);
-    if (nextDollar != std::string::npos) {
-        // ネストされた参照を先に評価
-        std::string nestedRef = ref.substr(nextDollar);
-        int nestedIndex = std::get<int>(resolveMemoryRef(nestedRef));
-        
-        // 外側の参照タイプを使って最終的な値を取得
-        char type = ref[startPos];
-        return getMemoryValue(type, nestedIndex);
+// 連続した要素をまとめて書き込み
+void MemoryMap::writeBlock(size_t index, size_t count, const void* data) {
+    if (index > windowSize || count > windowSize - index) {
+        throw std::out_of_range("Memory map range out of range: " + std::to_string(index) + "+" + std::to_string(count));
     }
-    
-    // 通常の参照処理
-    if (ref[startPos] == '#') {
-        return intPool[std::stoi(ref.substr(startPos + 1))];
-    } 
-    else if (ref[startPos] == '@') {
-        return stringPool[std::stoi(ref.substr(startPos + 1))];
-    } 
-    else if (ref[startPos] == '~') {
-        return floatPool[std::stoi(ref.substr(startPos + 1))];
-    } 
-    else if (ref[startPos] == '%') {
-        return boolPool[std::stoi(ref.substr(startPos + 1))];
+    if (count > 0) {
+        writeBytes((windowOffset + index) * elementSize(), count * elementSize(), data);
     }
-    throw std::runtime_error("Invalid memory reference: " + ref);
 }
 
-// メモリインデックスを評価する
-int Interpreter::evaluateMemoryIndex(const std::string& indexExpr) {
-    int startPos = (indexExpr[0] == '$') ? 1 : 0;
-    
-    if (indexExpr[startPos] == '#' || 
-        indexExpr[startPos] == '@' || 
-        indexExpr[startPos] == '~' || 
-        indexExpr[startPos] == '%') {
-        
-        // ネストされたメモリ参照かチェック
-        size_t nextDollar = indexExpr.find('$', startPos + 1);
-        if (nextDollar != std::string::npos) {
-            // ネストされた参照を先に評価
-            std::string nestedRef = indexExpr.substr(nextDollar);
-            int nestedValue = std::get<int>(resolveMemoryRef(nestedRef));
-            return nestedValue;
+// ウィンドウスライド（それまでの書き込みの反映を始める）
+void MemoryMap::slideWindow(long long offset) {
+    sync(false);
+    size_t newOffset;
+    if (offset < 0) {
+        // 0未満にならないようにクランプ
+        size_t back = static_cast<size_t>(-(offset + 1)) + 1;
+        newOffset = back < windowOffset ? windowOffset - back : 0;
+    } else {
+        newOffset = windowOffset + static_cast<size_t>(offset);
+    }
+    // ウィンドウの終わりまでファイルのオフセットで表せること
+    size_t limit = MEMORY_MAP_MAX_OFFSET / elementSize();
+    if (newOffset > limit || windowSize > limit - newOffset) {
+        throw std::out_of_range("Memory map window offset out of range: " + std::to_string(newOffset));
+    }
+    windowOffset = newOffset;
+}
+
+// ウィンドウの要素数を変える
+void MemoryMap::setWindowSize(size_t size) {
+    if (size == 0) {
+        throw std::invalid_argument("Memory map window size must be positive");
+    }
+    windowSize = size;
+}
+
+
+// メモリ参照のインデックスを解決する
+int Interpreter::resolveMemoryIndex(const MemoryDescriptor& mem) {
+    int index = mem.index;
+    for (size_t i = mem.indirection.size(); i-- > 0;) {
+        if (mem.indirection[i] == '#') {
+            index = getInt(index);
         } else {
-            // 通常の参照
-            return std::stoi(indexExpr.substr(startPos + 1));
+            index = std::get<int>(getMemoryValue(mem.indirection[i], index));
         }
     }
-    
-    throw std::runtime_error("Invalid memory index: " + indexExpr);
+    return index;
 }
 
 // メモリ値の取得
 Value Interpreter::getMemoryValue(char type, int index) {
-    if (index < 0 || index >= MEMORY_POOL_SIZE) {
-        throw std::out_of_range("Memory index out of range: " + std::to_string(index));
-    }
+    checkPoolIndex(index);
     switch (type) {
         case '#': return intPool[index];
         case '@': return stringPool[index];
         case '~': return floatPool[index];
-        case '%': return boolPool[index];
+        case '%': return static_cast<bool>(boolPool[index]);
         default: throw std::runtime_error("Invalid memory type: " + std::string(1, type));
     }
 }
 
 // メモリ値の設定
 void Interpreter::setMemoryValue(char type, int index, const Value& value) {
-    if (index < 0 || index >= MEMORY_POOL_SIZE) {
-        throw std::out_of_range("Memory index out of range: " + std::to_string(index));
-    }
+    checkPoolIndex(index);
     switch (type) {
-        case '#': intPool[index] = std::get<int>(value); break;
-        case '@': stringPool[index] = std::get<std::string>(value); break;
-        case '~': floatPool[index] = std::get<double>(value); break;
-        case '%': boolPool[index] = std::get<bool>(value); break;
-        default: throw std::runtime_error("Invalid memory type: " + std::string(1, type));
+        case '#':
+            if (const int* v = std::get_if<int>(&value)) { intPool[index] = *v; return; }
+            break;
+        case '@':
+            if (const std::string* v = std::get_if<std::string>(&value)) { stringPool[index] = *v; return; }
+            break;
+        case '~':
+            if (const double* v = std::get_if<double>(&value)) { floatPool[index] = *v; return; }
+            break;
+        case '%':
+            if (const bool* v = std::get_if<bool>(&value)) { boolPool[index] = *v; return; }
+            break;
+        default:
+            throw std::runtime_error("Invalid memory type: " + std::string(1, type));
     }
+    throw std::runtime_error("Type mismatch: cannot store " + valueToString(value) +
+                             " in $" + std::string(1, type) + std::to_string(index));
 }
 
 // 値を文字列に変換
@@ -326,6 +571,8 @@ Value Interpreter::evaluateNode(const std::shared_ptr<ASTNode>& node) {
             return evaluateNumber(node);
         case NodeType::String:
             return evaluateString(node);
+        case NodeType::Constant:
+            return *node->constant;
         case NodeType::Comparison:
             return evaluateComparison(node);
         case NodeType::Cast:
@@ -373,12 +620,54 @@ Value Interpreter::evaluateProgram(const std::shared_ptr<ASTNode>& program) {
 Value Interpreter::evaluateFunction(const std::shared_ptr<ASTNode>& node) {
     // 関数の定義を保存
     functions[std::stoi(node->value)] = node;
+    ++functionsVersion;
     return Value();
 }
 
+// マシン状態を初期状態に戻す
+void Interpreter::reset() {
+    intPool.fill(0);
+    floatPool.fill(0.0);
+    stringPool.fill(std::string());
+    boolPool.reset();
+    intStack.clear();
+    floatStack.clear();
+    stringStack.clear();
+    booleanStack.clear();
+    functions.clear();
+    ++functionsVersion;
+    jit.clear();
+    intMemoryMap = MemoryMap();
+    stringMemoryMap = MemoryMap();
+    floatMemoryMap = MemoryMap();
+    boolMemoryMap = MemoryMap();
+}
+
+// 定義済みの関数（ID順）
+std::vector<std::shared_ptr<ASTNode>> Interpreter::definedFunctions() const {
+    std::map<int, std::shared_ptr<ASTNode>> sorted(functions.begin(), functions.end());
+    std::vector<std::shared_ptr<ASTNode>> result;
+    for (const auto& entry : sorted) {
+        result.push_back(entry.second);
+    }
+    return result;
+}
+
+// スタックの要素数
+size_t Interpreter::stackSize(char type) const {
+    switch (type) {
+        case '#': return intStack.size();
+        case '~': return floatStack.size();
+        case '@': return stringStack.size();
+        case '%': return booleanStack.size();
+        default: throw std::runtime_error("Unknown stack type: " + std::string(1, type));
+    }
+}
+
 Value Interpreter::evaluateFunctionCall(const std::shared_ptr<ASTNode>& node) {
     // 関数の呼び出しを評価
-    auto it = functions.find(std::stoi(node->value));
+    int id = std::stoi(node->value);
+    auto it = functions.find(id);
     if (it != functions.end()) {
         // 関数の中身（子ノード）を順番に実行
         for (const auto& child : it->second->children) {
@@ -386,47 +675,175 @@ Value Interpreter::evaluateFunctionCall(const std::shared_ptr<ASTNode>& node) {
         }
         return Value();
     }
+    // ネイティブ関数（引数・戻り値はメモリプールで受け渡す）
+    if (const NativeFunction* native = NativeRegistry::find(id)) {
+        (*native)(*this);
+        return Value();
+    }
     throw std::runtime_error("Function not found: " + node->value);
 }
 
+// 被演算子の評価（定数はコピーせずに参照する）
+const Value& Interpreter::evaluateOperand(const std::shared_ptr<ASTNode>& node, Value& temp) {
+    if (node->constant) {
+        return *node->constant;
+    }
+    temp = evaluateNode(node);
+    return temp;
+}
+
 // 代入ノード評価
 Value Interpreter::evaluateAssignment(const std::shared_ptr<ASTNode>& node) {
-    std::string varName = node->children[0]->value;
-    Value value = evaluateNode(node->children[1]);
+    const MemoryDescriptor& mem = node->children[0]->memory;
+
+    // 複合代入（右辺は 左辺 op 式 の形）
+    const auto& source = node->children[1];
+    if (node->op != Operator::None && source->type == NodeType::ArithmeticExpression && 
+        source->children.size() == 2) {
+        return evaluateCompoundAssignment(node);
+    }
+
+    Value temp;
+    const Value& value = evaluateOperand(source, temp);
+
+    if (!mem.valid) {
+        throw std::runtime_error("Invalid assignment target: " + node->children[0]->value);
+    }
 
     // メモリマップ参照かチェック
-    if (varName.size() >= 3 && varName.substr(0, 2) == "$^") {
-        char mapType = varName[2];
-        MemoryMap& memMap = getMemoryMap(mapType);
-        
-        if (!memMap.isMapped()) {
-            throw std::runtime_error("Memory map not initialized for assignment: " + varName);
-        }
-        
-        // インデックス取得
-        size_t index = 0;
-        if (varName.size() > 3) {
-            index = std::stoi(varName.substr(3));
-        }
-        
-        // string型の特殊処理
-        if (mapType == '@' && std::holds_alternative<std::string>(value)) {
-            std::string strValue = std::get<std::string>(value);
-            // 文字列を1文字ずつ連続配置
-            for (size_t i = 0; i < strValue.size() && (index + i) < MEMORY_MAP_SIZE; ++i) {
-                memMap.writeElement(index + i, std::string(1, strValue[i]));
-            }
-        } 
-        else {
-            memMap.writeElement(index, value);
-        }
-        
-        return value;
+    if (mem.isMap) {
+        writeMemoryMap(mem.type, resolveMemoryIndex(mem), value);
     } else {
         // 通常のメモリ参照への代入
-        int startPos = (varName[0] == '$') ? 1 : 0;
-        setMemoryValue(varName[startPos], evaluateMemoryIndex(varName), value);
-        return value;
+        setMemoryValue(mem.type, resolveMemoryIndex(mem), value);
+    }
+    return Value();
+}
+
+// intの要素をその場で更新
+static void updateInt(Operator op, int& slot, int operand) {
+    switch (op) {
+        case Operator::Add: slot += operand; break;
+        case Operator::Subtract: slot -= operand; break;
+        case Operator::Multiply: slot *= operand; break;
+        case Operator::Divide:
+            if (operand == 0) throw std::runtime_error("Division by zero");
+            slot /= operand;
+            break;
+        case Operator::Modulus:
+            if (operand == 0) throw std::runtime_error("Modulo by zero");
+            slot %= operand;
+            break;
+        default:
+            throw std::runtime_error("Invalid compound assignment: " + operator2String(op));
+    }
+}
+
+// 複合代入ノード評価（対象を1度だけ解決してその場で更新する）
+Value Interpreter::evaluateCompoundAssignment(const std::shared_ptr<ASTNode>& node) {
+    const MemoryDescriptor& mem = node->children[0]->memory;
+    Value temp;
+    const Value& operand = evaluateOperand(node->children[1]->children[1], temp);
+
+    if (!mem.valid) {
+        throw std::runtime_error("Invalid assignment target: " + node->children[0]->value);
+    }
+
+    int index = resolveMemoryIndex(mem);
+    Operator op = node->op;
+
+    if (mem.isMap) {
+        Value current = readMemoryMap(mem.type, index);
+        writeMemoryMap(mem.type, index, applyArithmetic(op, current, operand));
+        return Value();
+    }
+
+    checkPoolIndex(index);
+    switch (mem.type) {
+        case '#':
+            if (const int* value = std::get_if<int>(&operand)) {
+                updateInt(op, intPool[index], *value);
+                return Value();
+            }
+            break;
+        case '~':
+            if (const double* value = std::get_if<double>(&operand)) {
+                double& slot = floatPool[index];
+                switch (op) {
+                    case Operator::Add: slot += *value; return Value();
+                    case Operator::Subtract: slot -= *value; return Value();
+                    case Operator::Multiply: slot *= *value; return Value();
+                    case Operator::Divide:
+                        if (*value == 0.0) throw std::runtime_error("Division by zero");
+                        slot /= *value;
+                        return Value();
+                    default: break;
+                }
+            }
+            break;
+        case '@':
+            // 文字列の連結は既存の文字列に追記する
+            if (op == Operator::Add) {
+                if (const std::string* value = std::get_if<std::string>(&operand)) {
+                    stringPool[index] += *value;
+                } else {
+                    stringPool[index] += valueToString(operand);
+                }
+                return Value();
+            }
+            break;
+        default:
+            break;
+    }
+
+    // それ以外は汎用の演算で計算して書き戻す
+    Value current = getMemoryValue(mem.type, index);
+    setMemoryValue(mem.type, index, applyArithmetic(op, current, operand));
+    return Value();
+}
+
+// 被演算子の型の組で特殊化する
+static Specialization specializationFor(const Value& left, const Value& right) {
+    if (std::holds_alternative<int>(left) && std::holds_alternative<int>(right)) {
+        return Specialization::IntInt;
+    }
+    if (std::holds_alternative<double>(left) && std::holds_alternative<double>(right)) {
+        return Specialization::FloatFloat;
+    }
+    return Specialization::Generic;
+}
+
+// int同士の算術演算
+static bool intArithmetic(Operator op, int lval, int rval, Value& result) {
+    switch (op) {
+        case Operator::Add: result = lval + rval; return true;
+        case Operator::Subtract: result = lval - rval; return true;
+        case Operator::Multiply: result = lval * rval; return true;
+        case Operator::Divide:
+            if (rval == 0) throw std::runtime_error("Division by zero");
+            result = lval / rval;
+            return true;
+        case Operator::Modulus:
+            if (rval == 0) throw std::runtime_error("Modulo by zero");
+            result = lval % rval;
+            return true;
+        default:
+            return false;
+    }
+}
+
+// double同士の算術演算
+static bool floatArithmetic(Operator op, double lval, double rval, Value& result) {
+    switch (op) {
+        case Operator::Add: result = lval + rval; return true;
+        case Operator::Subtract: result = lval - rval; return true;
+        case Operator::Multiply: result = lval * rval; return true;
+        case Operator::Divide:
+            if (rval == 0.0) throw std::runtime_error("Division by zero");
+            result = lval / rval;
+            return true;
+        default:
+            return false;
     }
 }
 
@@ -438,138 +855,76 @@ Value Interpreter::evaluateArithmeticExpression(const std::shared_ptr<ASTNode>&
     } 
     // 二項式
     else if (node->children.size() == 2) {
-        Value left = evaluateNode(node->children[0]);
-        Value right = evaluateNode(node->children[1]);
-        std::string op = node->value;
+        Value leftTemp, rightTemp;
+        const Value& left = evaluateOperand(node->children[0], leftTemp);
+        const Value& right = evaluateOperand(node->children[1], rightTemp);
+        Value result;
 
-        // int-int
-        if (std::holds_alternative<int>(left) && std::holds_alternative<int>(right)) {
-            int lval = std::get<int>(left);
-            int rval = std::get<int>(right);
-            
-            if (op == "+") return lval + rval;
-            if (op == "-") return lval - rval;
-            if (op == "*") return lval * rval;
-            if (op == "/") {
-                if (rval == 0) throw std::runtime_error("Division by zero");
-                return lval / rval;
-            }
-            if (op == "%") {
-                if (rval == 0) throw std::runtime_error("Modulo by zero");
-                return lval % rval;
-            }
-        } 
-        // double-double
-        else if (std::holds_alternative<double>(left) && std::holds_alternative<double>(right)) {
-            double lval = std::get<double>(left);
-            double rval = std::get<double>(right);
-            
-            if (op == "+") return lval + rval;
-            if (op == "-") return lval - rval;
-            if (op == "*") return lval * rval;
-            if (op == "/") {
-                if (rval == 0.0) throw std::runtime_error("Division by zero");
-                return lval / rval;
-            }
-        }
-        // int-double
-        else if (std::holds_alternative<int>(left) && std::holds_alternative<double>(right) 
-                || std::holds_alternative<double>(left) && std::holds_alternative<int>(right)) {
-            int lval = std::get<int>(left);
-            double rval = std::get<double>(right);
-            
-            if (op == "+") return lval + rval;
-            if (op == "-") return lval - rval;
-            if (op == "*") return lval * rval;
-            if (op == "/") {
-                if (rval == 0.0) throw std::runtime_error("Division by zero");
-                return lval / rval;
-            }
-        }
-        // int-bool
-        else if (std::holds_alternative<int>(left) && std::holds_alternative<bool>(right)) {
-            int lval = std::get<int>(left);
-            bool rval = std::get<bool>(right);
-            
-            if (op == "+") return lval + (rval ? 1 : 0);
-            if (op == "-") return lval - (rval ? 1 : 0);
-            if (op == "*") return lval * (rval ? 1 : 0);
-            if (op == "/") {
-                if (rval) return lval / 1;
-                throw std::runtime_error("Division by zero");
-            }
-            if (op == "%") {
-                if (rval == 0) throw std::runtime_error("Modulo by zero");
-                return lval % rval;
-            }
-        }
-        // double-bool
-        else if (std::holds_alternative<double>(left) && std::holds_alternative<bool>(right)) {
-            double lval = std::get<double>(left);
-            bool rval = std::get<bool>(right);
-            
-            if (op == "+") return lval + (rval ? 1.0 : 0.0);
-            if (op == "-") return lval - (rval ? 1.0 : 0.0);
-            if (op == "*") return lval * (rval ? 1.0 : 0.0);
-            if (op == "/") {
-                if (rval) return lval / 1.0;
-                throw std::runtime_error("Division by zero");
-            }
-        }
-        // bool-int
-        else if (std::holds_alternative<bool>(left) && std::holds_alternative<int>(right)) {
-            bool lval = std::get<bool>(left);
-            int rval = std::get<int>(right);
-            
-            if (op == "+") return (lval ? 1 : 0) + rval;
-            if (op == "-") return (lval ? 1 : 0) - rval;
-            if (op == "*") return (lval ? 1 : 0) * rval;
-            if (op == "/") {
-                if (rval == 0) throw std::runtime_error("Division by zero");
-                return (lval ? 1 : 0) / rval;
-            }
-            if (op == "%") {
-                if (rval == 0) throw std::runtime_error("Modulo by zero");
-                return lval % rval;
-            }
-        }
-        // bool-double
-        else if (std::holds_alternative<bool>(left) && std::holds_alternative<double>(right)) {
-            bool lval = std::get<bool>(left);
-            double rval = std::get<double>(right);
-            
-            if (op == "+") return (lval ? 1.0 : 0.0) + rval;
-            if (op == "-") return (lval ? 1.0 : 0.0) - rval;
-            if (op == "*") return (lval ? 1.0 : 0.0) * rval;
-            if (op == "/") {
-                if (rval == 0.0) throw std::runtime_error("Division by zero");
-                return (lval ? 1.0 : 0.0) / rval;
-            }
+        // 特殊化されていればガードを確認して直接計算、外れたら汎用処理に戻す
+        switch (node->specialization.load(std::memory_order_relaxed)) {
+            case Specialization::IntInt:
+                if (std::holds_alternative<int>(left) && std::holds_alternative<int>(right) &&
+                    intArithmetic(node->op, std::get<int>(left), std::get<int>(right), result)) {
+                    return result;
+                }
+                node->specialization.store(Specialization::Generic, std::memory_order_relaxed);
+                break;
+            case Specialization::FloatFloat:
+                if (std::holds_alternative<double>(left) && std::holds_alternative<double>(right) &&
+                    floatArithmetic(node->op, std::get<double>(left), std::get<double>(right), result)) {
+                    return result;
+                }
+                node->specialization.store(Specialization::Generic, std::memory_order_relaxed);
+                break;
+            case Specialization::Unspecialized:
+                node->specialization.store(specializationFor(left, right), std::memory_order_relaxed);
+                break;
+            case Specialization::Generic:
+                break;
         }
-        // bool-bool
-        else if (std::holds_alternative<bool>(left) && std::holds_alternative<bool>(right)) {
-            bool lval = std::get<bool>(left);
-            bool rval = std::get<bool>(right);
-            
-            if (op == "+") return (lval ? 1 : 0) + (rval ? 1 : 0);
-            if (op == "-") return (lval ? 1 : 0) - (rval ? 1 : 0);
-            if (op == "*") return (lval ? 1 : 0) * (rval ? 1 : 0);
-            if (op == "/") {
-                if (!rval) throw std::runtime_error("Division by zero");
-                return (lval ? 1 : 0) / (rval ? 1 : 0);
-            }
-            if (op == "%") {
-                if (!rval) throw std::runtime_error("Modulo by zero");
-                return (lval ? 1 : 0) % (rval ? 1 : 0);
-            }
+        return applyArithmetic(node->op, left, right);
+    }
+    throw std::runtime_error("Invalid arithmetic expression: " + node->toJSON());
+}
+
+// 整数として扱える値か（boolは0/1）
+static bool isIntegral(const Value& val) {
+    return std::holds_alternative<int>(val) || std::holds_alternative<bool>(val);
+}
+
+// 整数に変換（boolは0/1）
+static int toInt(const Value& val) {
+    if (std::holds_alternative<int>(val)) return std::get<int>(val);
+    return std::get<bool>(val) ? 1 : 0;
+}
+
+// 浮動小数点数に変換
+static double toDouble(const Value& val) {
+    if (std::holds_alternative<double>(val)) return std::get<double>(val);
+    return toInt(val);
+}
+
+// 算術演算
+Value Interpreter::applyArithmetic(Operator op, const Value& left, const Value& right) {
+    Value result;
+    // int/bool同士
+    if (isIntegral(left) && isIntegral(right)) {
+        if (intArithmetic(op, toInt(left), toInt(right), result)) {
+            return result;
         }
-        // str-任意の型
-        else if ((std::holds_alternative<std::string>(left) || 
-                  std::holds_alternative<std::string>(right)) && op == "+") {
-            return valueToString(left) + valueToString(right);
+    } 
+    // doubleを含む数値
+    else if (!std::holds_alternative<std::string>(left) && !std::holds_alternative<std::string>(right)) {
+        if (floatArithmetic(op, toDouble(left), toDouble(right), result)) {
+            return result;
         }
     }
-    throw std::runtime_error("Invalid arithmetic expression: " + node->toJSON());
+    // str-任意の型
+    else if (op == Operator::Add) {
+        return valueToString(left) + valueToString(right);
+    }
+    throw std::runtime_error("Invalid arithmetic expression: " + valueToString(left) + " " + 
+                             operator2String(op) + " " + valueToString(right));
 }
 
 // 論理式ノード評価
@@ -577,7 +932,7 @@ Value Interpreter::evaluateLogicalExpression(const std::shared_ptr<ASTNode>& nod
     // 単項式
     if (node->children.size() == 1) {
         // 単項否定
-        if (node->value == "!") {
+        if (node->op == Operator::Not) {
             Value childValue = evaluateNode(node->children[0]);
             if (std::holds_alternative<bool>(childValue)) {
                 return !std::get<bool>(childValue);
@@ -590,142 +945,168 @@ Value Interpreter::evaluateLogicalExpression(const std::shared_ptr<ASTNode>& nod
     else if (node->children.size() == 2) {
         Value left = evaluateNode(node->children[0]);
         Value right = evaluateNode(node->children[1]);
-        std::string op = node->value;
 
         if (std::holds_alternative<bool>(left) && std::holds_alternative<bool>(right)) {
             bool lval = std::get<bool>(left);
             bool rval = std::get<bool>(right);
             
-            if (op == "&&") return lval && rval;
-            if (op == "||") return lval || rval;
+            switch (node->op) {
+                case Operator::And: return lval && rval;
+                case Operator::Or: return lval || rval;
+                default: break;
+            }
         }
     }
     throw std::runtime_error("Invalid logical expression: " + node->toJSON());
 }
 
+// 同じ型同士の比較
+template <typename T>
+static bool compareValues(Operator op, const T& lval, const T& rval, Value& result) {
+    switch (op) {
+        case Operator::Equal: result = lval == rval; return true;
+        case Operator::NotEqual: result = lval != rval; return true;
+        case Operator::Less: result = lval < rval; return true;
+        case Operator::LessEqual: result = lval <= rval; return true;
+        case Operator::Greater: result = lval > rval; return true;
+        case Operator::GreaterEqual: result = lval >= rval; return true;
+        default: return false;
+    }
+}
+
 // 比較式ノード評価
 Value Interpreter::evaluateComparison(const std::shared_ptr<ASTNode>& node) {
-    Value left = evaluateNode(node->children[0]);
-    Value right = evaluateNode(node->children[1]);
-    std::string op = node->value;
+    Value leftTemp, rightTemp;
+    const Value& left = evaluateOperand(node->children[0], leftTemp);
+    const Value& right = evaluateOperand(node->children[1], rightTemp);
+    Value result;
+
+    // 特殊化されていればガードを確認して直接比較、外れたら汎用処理に戻す
+    switch (node->specialization.load(std::memory_order_relaxed)) {
+        case Specialization::IntInt:
+            if (std::holds_alternative<int>(left) && std::holds_alternative<int>(right) &&
+                compareValues(node->op, std::get<int>(left), std::get<int>(right), result)) {
+                return result;
+            }
+            node->specialization.store(Specialization::Generic, std::memory_order_relaxed);
+            break;
+        case Specialization::FloatFloat:
+            if (std::holds_alternative<double>(left) && std::holds_alternative<double>(right) &&
+                compareValues(node->op, std::get<double>(left), std::get<double>(right), result)) {
+                return result;
+            }
+            node->specialization.store(Specialization::Generic, std::memory_order_relaxed);
+            break;
+        case Specialization::Unspecialized:
+            node->specialization.store(specializationFor(left, right), std::memory_order_relaxed);
+            break;
+        case Specialization::Generic:
+            break;
+    }
+    return applyComparison(node->op, left, right);
+}
+
+// 比較演算
+Value Interpreter::applyComparison(Operator op, const Value& left, const Value& right) {
+    bool leftNumber = std::holds_alternative<int>(left) || std::holds_alternative<double>(left);
+    bool rightNumber = std::holds_alternative<int>(right) || std::holds_alternative<double>(right);
+    Value result;
 
     if (std::holds_alternative<int>(left) && std::holds_alternative<int>(right)) {
-        int lval = std::get<int>(left);
-        int rval = std::get<int>(right);
-        
-        if (op == "==") return lval == rval;
-        if (op == "!=") return lval != rval;
-        if (op == "<") return lval < rval;
-        if (op == "<=") return lval <= rval;
-        if (op == ">") return lval > rval;
-        if (op == ">=") return lval >= rval;
-    }
-    else if (std::holds_alternative<double>(left) && std::holds_alternative<double>(right)) {
-        double lval = std::get<double>(left);
-        double rval = std::get<double>(right);
-        
-        if (op == "==") return lval == rval;
-        if (op == "!=") return lval != rval;
-        if (op == "<") return lval < rval;
-        if (op == "<=") return lval <= rval;
-        if (op == ">") return lval > rval;
-        if (op == ">=") return lval >= rval;
-    } 
-    else if (std::holds_alternative<int>(left) && std::holds_alternative<double>(right)) {
-        int lval = std::get<int>(left);
-        double rval = std::get<double>(right);
-        
-        if (op == "==") return lval == rval;
-        if (op == "!=") return lval != rval;
-        if (op == "<") return lval < rval;
-        if (op == "<=") return lval <= rval;
-        if (op == ">") return lval > rval;
-        if (op == ">=") return lval >= rval;
-    } 
-    else if (std::holds_alternative<double>(left) && std::holds_alternative<int>(right)) {
-        double lval = std::get<double>(left);
-        int rval = std::get<int>(right);
-        
-        if (op == "==") return lval == rval;
-        if (op == "!=") return lval != rval;
-        if (op == "<") return lval < rval;
-        if (op == "<=") return lval <= rval;
-        if (op == ">") return lval > rval;
-        if (op == ">=") return lval >= rval;
+        if (compareValues(op, std::get<int>(left), std::get<int>(right), result)) {
+            return result;
+        }
+    }
+    // doubleを含む数値
+    else if (leftNumber && rightNumber) {
+        if (compareValues(op, toDouble(left), toDouble(right), result)) {
+            return result;
+        }
     }
     else if (std::holds_alternative<bool>(left) && std::holds_alternative<bool>(right)) {
         bool lval = std::get<bool>(left);
         bool rval = std::get<bool>(right);
         
-        if (op == "==") return lval == rval;
-        if (op == "!=") return lval != rval;
+        if (op == Operator::Equal) return lval == rval;
+        if (op == Operator::NotEqual) return lval != rval;
     }
     else if (std::holds_alternative<std::string>(left) && std::holds_alternative<std::string>(right)) {
-        std::string lval = std::get<std::string>(left);
-        std::string rval = std::get<std::string>(right);
+        const std::string& lval = std::get<std::string>(left);
+        const std::string& rval = std::get<std::string>(right);
         
-        if (op == "==") return lval == rval;
-        if (op == "!=") return lval != rval;
+        if (op == Operator::Equal) return lval == rval;
+        if (op == Operator::NotEqual) return lval != rval;
     }
 
-    if (op == "==" || op == "!=") {
+    // 型が異なる場合は文字列として比較
+    if (op == Operator::Equal || op == Operator::NotEqual) {
         std::string lstr = valueToString(left);
         std::string rstr = valueToString(right);
         
-        if (op == "==") return lstr == rstr;
-        if (op == "!=") return lstr != rstr;
+        if (op == Operator::Equal) return lstr == rstr;
+        return lstr != rstr;
     }
 
-    throw std::runtime_error("Invalid comparison: " + node->toJSON());
+    throw std::runtime_error("Invalid comparison: " + valueToString(left) + " " + 
+                             operator2String(op) + " " + valueToString(right));
 }
 
 // 型変換ノード評価
 Value Interpreter::evaluateCast(const std::shared_ptr<ASTNode>& node) {
     Value value = evaluateNode(node->children[0]);
-    std::string targetType = node->value;
-
-    if (targetType == "int") {
-        if (std::holds_alternative<double>(value)) {
-            return static_cast<int>(std::get<double>(value));
-        } 
-        else if (std::holds_alternative<std::string>(value)) {
-            return std::stoi(std::get<std::string>(value));
-        }
-    } 
-    else if (targetType == "double") {
-        if (std::holds_alternative<int>(value)) {
-            return static_cast<double>(std::get<int>(value));
-        } 
-        else if (std::holds_alternative<std::string>(value)) {
-            return std::stod(std::get<std::string>(value));
-        }
-    } 
-    else if (targetType == "string") {
-        return valueToString(value);
-    } 
-    else if (targetType == "bool") {
-        if (std::holds_alternative<int>(value)) {
-            return std::get<int>(value) != 0;
-        } 
-        else if (std::holds_alternative<double>(value)) {
-            return std::get<double>(value) != 0.0;
-        } 
-        else if (std::holds_alternative<std::string>(value)) {
-            return !std::get<std::string>(value).empty();
-        }
+    return applyCast(node->op, value);
+}
+
+// 型変換
+Value Interpreter::applyCast(Operator targetType, const Value& value) {
+    switch (targetType) {
+        case Operator::IntCast:
+            if (std::holds_alternative<double>(value)) {
+                return static_cast<int>(std::get<double>(value));
+            } 
+            else if (std::holds_alternative<std::string>(value)) {
+                return std::stoi(std::get<std::string>(value));
+            }
+            break;
+        case Operator::FloatCast:
+            if (std::holds_alternative<int>(value)) {
+                return static_cast<double>(std::get<int>(value));
+            } 
+            else if (std::holds_alternative<std::string>(value)) {
+                return std::stod(std::get<std::string>(value));
+            }
+            break;
+        case Operator::StringCast:
+            return valueToString(value);
+        case Operator::BoolCast:
+            if (std::holds_alternative<int>(value)) {
+                return std::get<int>(value) != 0;
+            } 
+            else if (std::holds_alternative<double>(value)) {
+                return std::get<double>(value) != 0.0;
+            } 
+            else if (std::holds_alternative<std::string>(value)) {
+                return !std::get<std::string>(value).empty();
+            }
+            break;
+        default:
+            break;
     }
 
-    throw std::runtime_error("Invalid cast: " + node->toJSON());
+    throw std::runtime_error("Invalid cast: " + operator2String(targetType) + " from " + valueToString(value));
 }
 
 // 文字コード変換ノード評価
 Value Interpreter::evaluateCharCodeCast(const std::shared_ptr<ASTNode>& node) {
     Value value = evaluateNode(node->children[0]);
-    std::string castType = node->value;
+    return applyCharCodeCast(node->op, value);
+}
 
-    if (castType == "charToInt") {
+// 文字コード変換
+Value Interpreter::applyCharCodeCast(Operator castType, const Value& value) {
+    if (castType == Operator::CharToInt) {
         if (std::holds_alternative<std::string>(value)) {
-            std::string str = std::get<std::string>(value);
+            const std::string& str = std::get<std::string>(value);
             if (str.length() == 1) {
                 return static_cast<int>(static_cast<unsigned char>(str[0]));
             }
@@ -733,7 +1114,7 @@ Value Interpreter::evaluateCharCodeCast(const std::shared_ptr<ASTNode>& node) {
         }
         throw std::runtime_error("Character code cast (charToInt) requires string type");
     }
-    else if (castType == "intToChar") {
+    else if (castType == Operator::IntToChar) {
         if (std::holds_alternative<int>(value)) {
             int code = std::get<int>(value);
             if (code >= 0 && code <= 127) {  // ASCII範囲
@@ -745,7 +1126,7 @@ Value Interpreter::evaluateCharCodeCast(const std::shared_ptr<ASTNode>& node) {
         throw std::runtime_error("Character code cast (intToChar) requires int type");
     }
 
-    throw std::runtime_error("Invalid character code cast: " + node->toJSON());
+    throw std::runtime_error("Invalid character code cast: " + operator2String(castType));
 }
 
 // インデックスアクセスノード評価
@@ -826,66 +1207,168 @@ Value Interpreter::evaluateIfStatement(const std::shared_ptr<ASTNode>& node) {
 
 // ループ文ノード評価
 Value Interpreter::evaluateLoopStatement(const std::shared_ptr<ASTNode>& node) {
+    LoopJit::Profile* profile = jitEnabled ? &jit.profile(node) : nullptr;
     while (true) {
         Value condition = evaluateNode(node->children[0]);
         if (std::holds_alternative<bool>(condition) && !std::get<bool>(condition)) {
             break;
         }
         evaluateNode(node->children[1]);
+
+        // ホットなループは残りの反復をネイティブコードで実行
+        if (profile) {
+            if (JitFunction function = jit.countIteration(*profile, node, functions, functionsVersion)) {
+                runNativeLoop(function);
+                break;
+            }
+        }
     }
     return Value();
 }
 
+// コンパイル済みのループを実行
+void Interpreter::runNativeLoop(JitFunction function) {
+    static_assert(MEMORY_POOL_SIZE == 64, "JIT expects the bool pool to fit in 64 bits");
+
+    uint64_t boolBits = boolPool.to_ullong();
+    int status = function(intPool.data(), &boolBits);
+    boolPool = std::bitset<MEMORY_POOL_SIZE>(boolBits);
+
+    switch (static_cast<JitStatus>(status)) {
+        case JitStatus::DivisionByZero: throw std::runtime_error("Division by zero");
+        case JitStatus::ModuloByZero: throw std::runtime_error("Modulo by zero");
+        default: break;
+    }
+}
+
 // 入力文ノード評価
 Value Interpreter::evaluateInputStatement(const std::shared_ptr<ASTNode>& node) {
-    std::string varName = node->children[0]->value;
-    int startPos = (varName[0] == '$') ? 1 : 0;
-    char memType = varName[startPos];
-    std::string input;
-    std::cout << "Input " << varName << ": ";
-    std::cin >> input;
+    const std::string& varName = node->children[0]->value;
+    const MemoryDescriptor& mem = node->children[0]->memory;
+    if (!mem.valid || mem.isMap) {
+        throw std::runtime_error("Invalid memory reference for input: " + varName);
+    }
+    char memType = mem.type;
+    if (!inputPrompt) {
+        readBufferedInput(memType, resolveMemoryIndex(mem), varName);
+        return Value();
+    }
+    std::string text;
+    output.write(std::string_view("Input "));
+    output.write(varName);
+    output.write(std::string_view(": "));
+    output.flush();
+    *input >> text;
     
     // メモリタイプに応じて適切な型に変換
     Value convertedValue;
     switch (memType) {
         case '#': // int
-            convertedValue = std::stoi(input);
+            convertedValue = std::stoi(text);
             break;
         case '~': // double
-            convertedValue = std::stod(input);
+            convertedValue = std::stod(text);
             break;
         case '%': // bool
-            convertedValue = (input == "true" || input == "1");
+            convertedValue = (text == "true" || text == "1");
             break;
         case '@': // string
-            convertedValue = input;
+            convertedValue = text;
             break;
         default:
             throw std::runtime_error("Unknown memory type for input: " + std::string(1, memType));
     }
     
-    setMemoryValue(memType, evaluateMemoryIndex(varName), convertedValue);
+    setMemoryValue(memType, resolveMemoryIndex(mem), convertedValue);
     return Value();
 }
 
-// 出力文ノード評価
+// 入力の語を数値に変換（語全体が数値でなければエラー）
+template <typename T>
+static T parseInputNumber(const std::string& text, const std::string& varName) {
+    const char* first = text.data();
+    const char* last = first + text.size();
+    if (first != last && *first == '+') {
+        ++first;
+    }
+    T value{};
+    auto [end, error] = std::from_chars(first, last, value);
+    if (error == std::errc::result_out_of_range) {
+        throw std::out_of_range("Input out of range for " + varName + ": " + text);
+    }
+    if (error != std::errc() || end != last || first == last) {
+        throw std::runtime_error("Invalid input for " + varName + ": " + text);
+    }
+    return value;
+}
+
+// バッファから入力文の値を読んでスロットに入れる
+// 数値と真偽値は空白で区切られた語を1つ、文字列は1行を読む
+void Interpreter::readBufferedInput(char memType, int index, const std::string& varName) {
+    checkPoolIndex(index);
+    InputReader& reader = getInputReader();
+    if (memType == '@') {
+        if (!reader.readLine(stringPool[index])) {
+            throw std::runtime_error("Unexpected end of input for " + varName);
+        }
+        return;
+    }
+    if (!reader.readToken(inputToken)) {
+        throw std::runtime_error("Unexpected end of input for " + varName);
+    }
+    switch (memType) {
+        case '#': // int
+            intPool[index] = parseInputNumber<int>(inputToken, varName);
+            break;
+        case '~': // double
+            floatPool[index] = parseInputNumber<double>(inputToken, varName);
+            break;
+        case '%': // bool
+            boolPool[index] = (inputToken == "true" || inputToken == "1");
+            break;
+        default:
+            throw std::runtime_error("Unknown memory type for input: " + std::string(1, memType));
+    }
+}
+
+// 出力文ノード評価（式のない出力文は溜めた出力を流す）
 Value Interpreter::evaluateOutputStatement(const std::shared_ptr<ASTNode>& node) {
-    Value value = evaluateNode(node->children[0]);
-    std::cout << valueToString(value) << std::endl;
+    if (node->children.empty()) {
+        output.flush();
+        return Value();
+    }
+    Value temp;
+    writeLine(evaluateOperand(node->children[0], temp));
     return Value();
 }
 
+// 出力文の値を1行書く
+void Interpreter::writeLine(const Value& value) {
+    if (const int* v = std::get_if<int>(&value)) {
+        output.write(*v);
+    } else if (const double* v = std::get_if<double>(&value)) {
+        output.write(*v);
+    } else if (const bool* v = std::get_if<bool>(&value)) {
+        output.write(*v);
+    } else if (const std::string* v = std::get_if<std::string>(&value)) {
+        output.write(std::string_view(*v));
+    }
+    output.endLine();
+}
+
 // ファイル入力文ノード評価
 Value Interpreter::evaluateFileInputStatement(const std::shared_ptr<ASTNode>& node) {
     std::string filename = std::get<std::string>(evaluateNode(node->children[0]));
-    std::string targetName = node->children[1]->value;
+    const MemoryDescriptor& mem = node->children[1]->memory;
+    if (!mem.valid) {
+        throw std::runtime_error("Invalid memory reference for file input: " + node->children[1]->value);
+    }
 
     // メモリマップ参照かチェック
-    if (targetName.size() >= 3 && targetName.substr(0, 2) == "$^") {
+    if (mem.isMap) {
         // メモリマップにファイルをマッピング
-        char mapType = targetName[2];
-        MemoryMap& memMap = getMemoryMap(mapType);
-        memMap.mapFile(filename, mapType);
+        MemoryMap& memMap = getMemoryMap(mem.type);
+        memMap.mapFile(filename, mem.type);
         return Value();
     } else {
         // 通常のメモリ参照への読み込み
@@ -895,27 +1378,31 @@ Value Interpreter::evaluateFileInputStatement(const std::shared_ptr<ASTNode>& no
         }
         std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
         
-        int startPos = (targetName[0] == '$') ? 1 : 0;
-        setMemoryValue(targetName[startPos], evaluateMemoryIndex(targetName), content);
+        setMemoryValue(mem.type, resolveMemoryIndex(mem), content);
         return Value();
     }
 }
 
-// ファイル出力文ノード評価
+// ファイル出力文ノード評価（ファイル名のない "<<;" はメモリマップを同期する）
 Value Interpreter::evaluateFileOutputStatement(const std::shared_ptr<ASTNode>& node) {
+    if (node->children.empty()) {
+        syncMemoryMaps();
+        return Value();
+    }
     std::string filename = std::get<std::string>(evaluateNode(node->children[0]));
-    std::string sourceName = node->children[1]->value;
+    const MemoryDescriptor& mem = node->children[1]->memory;
 
     // メモリマップ参照かチェック
-    if (sourceName.size() >= 3 && sourceName.substr(0, 2) == "$^") {
+    if (mem.valid && mem.isMap) {
         // メモリマップからファイルに書き出し
-        char mapType = sourceName[2];
-        MemoryMap& memMap = getMemoryMap(mapType);
+        MemoryMap& memMap = getMemoryMap(mem.type);
         
         if (!memMap.isMapped()) {
             throw std::runtime_error("Memory map not initialized for output");
         }
         
+        // 書き込みはマップ済みなので、ディスクへの反映を待つ
+        memMap.sync(true);
         return Value();
     } 
     else {
@@ -928,98 +1415,124 @@ Value Interpreter::evaluateFileOutputStatement(const std::shared_ptr<ASTNode>& n
         }
         
         file << valueToString(value);
+        file.close();
+
+        // マップ中のファイルを書き換えたらマップし直す（縮んだページに触れないように）
+        for (MemoryMap* memMap : {&intMemoryMap, &stringMemoryMap, &floatMemoryMap, &boolMemoryMap}) {
+            if (memMap->isMapped() && memMap->getFilePath() == filename) {
+                memMap->reload();
+            }
+        }
         return Value();
     }
 }
 
 // スタック操作ノード評価
 Value Interpreter::evaluateStackOperation(const std::shared_ptr<ASTNode>& node) {
-    std::string op = node->value;
     Value val = evaluateNode(node->children[0]);
 
-    if (op == "IntegerStackPush") {
-        if (intStack.size() >= 1024) throw std::runtime_error("Integer stack overflow");
-        intStack.push_back(std::get<int>(val));
-        return Value();
-    }
-    if (op == "IntegerStackPop") {
-        if (intStack.empty()) throw std::runtime_error("Integer stack underflow");
-        int result = intStack.back();
-        intStack.pop_back();
-        return result;
-    }
-    if (op == "FloatStackPush") {
-        if (floatStack.size() >= 1024) throw std::runtime_error("Float stack overflow");
-        floatStack.push_back(std::get<double>(val));
-        return Value();
-    }
-    if (op == "FloatStackPop") {
-        if (floatStack.empty()) throw std::runtime_error("Float stack underflow");
-        double result = floatStack.back();
-        floatStack.pop_back();
-        return result;
-    }
-    if (op == "StringStackPush") {
-        if (stringStack.size() >= 1024) throw std::runtime_error("String stack overflow");
-        stringStack.push_back(std::get<std::string>(val));
-        return Value();
-    }
-    if (op == "StringStackPop") {
-        if (stringStack.empty()) throw std::runtime_error("String stack underflow");
-        std::string result = stringStack.back();
-        stringStack.pop_back();
-        return result;
+    switch (node->op) {
+        case Operator::IntegerStackPush: pushStack('#', val); return Value();
+        case Operator::IntegerStackPop: return popStack('#');
+        case Operator::FloatStackPush: pushStack('~', val); return Value();
+        case Operator::FloatStackPop: return popStack('~');
+        case Operator::StringStackPush: pushStack('@', val); return Value();
+        case Operator::StringStackPop: return popStack('@');
+        case Operator::BooleanStackPush: pushStack('%', val); return Value();
+        case Operator::BooleanStackPop: return popStack('%');
+        default: throw std::runtime_error("Unknown stack operation: " + node->value);
     }
-    if (op == "BooleanStackPush") {
-        if (booleanStack.size() >= 1024) throw std::runtime_error("Boolean stack overflow");
-        booleanStack.push_back(std::get<bool>(val));
-        return Value();
+}
+
+// スタックへのプッシュ
+void Interpreter::pushStack(char type, const Value& value) {
+    switch (type) {
+        case '#':
+            if (intStack.size() >= STACK_MAX_SIZE) throw std::runtime_error("Integer stack overflow");
+            intStack.push_back(std::get<int>(value));
+            break;
+        case '~':
+            if (floatStack.size() >= STACK_MAX_SIZE) throw std::runtime_error("Float stack overflow");
+            floatStack.push_back(std::get<double>(value));
+            break;
+        case '@':
+            if (stringStack.size() >= STACK_MAX_SIZE) throw std::runtime_error("String stack overflow");
+            stringStack.push_back(std::get<std::string>(value));
+            break;
+        case '%':
+            if (booleanStack.size() >= STACK_MAX_SIZE) throw std::runtime_error("Boolean stack overflow");
+            booleanStack.push_back(std::get<bool>(value));
+            break;
+        default:
+            throw std::runtime_error("Invalid stack type: " + std::string(1, type));
     }
-    if (op == "BooleanStackPop") {
-        if (booleanStack.empty()) throw std::runtime_error("Boolean stack underflow");
-        bool result = booleanStack.back();
-        booleanStack.pop_back();
-        return result;
+}
+
+// スタックからのポップ
+Value Interpreter::popStack(char type) {
+    switch (type) {
+        case '#': {
+            if (intStack.empty()) throw std::runtime_error("Integer stack underflow");
+            int result = intStack.back();
+            intStack.pop_back();
+            return result;
+        }
+        case '~': {
+            if (floatStack.empty()) throw std::runtime_error("Float stack underflow");
+            double result = floatStack.back();
+            floatStack.pop_back();
+            return result;
+        }
+        case '@': {
+            if (stringStack.empty()) throw std::runtime_error("String stack underflow");
+            std::string result = std::move(stringStack.back());
+            stringStack.pop_back();
+            return result;
+        }
+        case '%': {
+            if (booleanStack.empty()) throw std::runtime_error("Boolean stack underflow");
+            bool result = booleanStack.back();
+            booleanStack.pop_back();
+            return result;
+        }
+        default:
+            throw std::runtime_error("Invalid stack type: " + std::string(1, type));
     }
-    throw std::runtime_error("Unknown stack operation: " + op);
 }
 
 // メモリ参照ノード評価
 Value Interpreter::evaluateMemoryRef(const std::shared_ptr<ASTNode>& node) {
-    return resolveMemoryRef(node->value);
+    const MemoryDescriptor& mem = node->memory;
+    if (!mem.valid || mem.isMap) {
+        throw std::runtime_error("Invalid memory reference: " + node->value);
+    }
+    return getMemoryValue(mem.type, resolveMemoryIndex(mem));
 }
 
 // 数値ノード評価
 Value Interpreter::evaluateNumber(const std::shared_ptr<ASTNode>& node) {
+    if (node->constant) {
+        return *node->constant;
+    }
     return std::stoi(node->value);
 }
 
 // 文字列ノード評価
 Value Interpreter::evaluateString(const std::shared_ptr<ASTNode>& node) {
+    if (node->constant) {
+        return *node->constant;
+    }
     return node->value;
 }
 
 // メモリマップ参照ノード評価
 Value Interpreter::evaluateMemoryMapRef(const std::shared_ptr<ASTNode>& node) {
-    std::string mapRef = node->value;
-    if (mapRef.size() < 3 || mapRef.substr(0, 2) != "$^") {
-        throw std::runtime_error("Invalid memory map reference: " + mapRef);
-    }
-    
-    char mapType = mapRef[2];
-    MemoryMap& memMap = getMemoryMap(mapType);
-    
-    if (!memMap.isMapped()) {
-        throw std::runtime_error("Memory map not initialized for type: " + std::string(1, mapType));
-    }
-    
-    // インデックス取得
-    size_t index = 0;
-    if (mapRef.size() > 3) {
-        index = std::stoi(mapRef.substr(3));
+    const MemoryDescriptor& mem = node->memory;
+    if (!mem.valid || !mem.isMap) {
+        throw std::runtime_error("Invalid memory map reference: " + node->value);
     }
     
-    return memMap.readElement(index);
+    return readMemoryMap(mem.type, resolveMemoryIndex(mem));
 }
 
 // マップウィンドウスライドノード評価
@@ -1033,13 +1546,12 @@ Value Interpreter::evaluateMapWindowSlide(const std::shared_ptr<ASTNode>& node)
     int slideAmount = std::get<int>(slideAmountValue);
     
     // メモリマップ参照を取得
-    std::string mapRefStr = node->children[1]->value;
-    if (mapRefStr.size() < 3 || mapRefStr.substr(0, 2) != "$^") {
-        throw std::runtime_error("Invalid memory map reference in slide: " + mapRefStr);
+    const MemoryDescriptor& mem = node->children[1]->memory;
+    if (!mem.valid || !mem.isMap) {
+        throw std::runtime_error("Invalid memory map reference in slide: " + node->children[1]->value);
     }
     
-    char mapType = mapRefStr[2];
-    MemoryMap& memMap = getMemoryMap(mapType);
+    MemoryMap& memMap = getMemoryMap(mem.type);
     
     if (!memMap.isMapped()) {
         throw std::runtime_error("Memory map not initialized for slide operation");
@@ -1059,3 +1571,49 @@ MemoryMap& Interpreter::getMemoryMap(char type) {
         default: throw std::runtime_error("Unknown memory map type: " + std::string(1, type));
     }
 }
+
+// すべてのメモリマップのウィンドウの要素数を変える
+void Interpreter::setMapWindowSize(size_t size) {
+    for (MemoryMap* memMap : {&intMemoryMap, &stringMemoryMap, &floatMemoryMap, &boolMemoryMap}) {
+        memMap->setWindowSize(size);
+    }
+}
+
+// すべてのメモリマップをファイルに同期する
+void Interpreter::syncMemoryMaps() {
+    for (MemoryMap* memMap : {&intMemoryMap, &stringMemoryMap, &floatMemoryMap, &boolMemoryMap}) {
+        memMap->sync(true);
+    }
+}
+
+// メモリマップ要素の読み取り
+Value Interpreter::readMemoryMap(char mapType, size_t index) {
+    MemoryMap& memMap = getMemoryMap(mapType);
+    
+    if (!memMap.isMapped()) {
+        throw std::runtime_error("Memory map not initialized for type: " + std::string(1, mapType));
+    }
+    
+    return memMap.readElement(index);
+}
+
+// メモリマップ要素への書き込み
+void Interpreter::writeMemoryMap(char mapType, size_t index, const Value& value) {
+    MemoryMap& memMap = getMemoryMap(mapType);
+    
+    if (!memMap.isMapped()) {
+        throw std::runtime_error("Memory map not initialized for assignment: $^" + std::string(1, mapType));
+    }
+    
+    // string型の特殊処理
+    if (mapType == '@' && std::holds_alternative<std::string>(value)) {
+        const std::string& strValue = std::get<std::string>(value);
+        // 文字列を1文字ずつ連続配置
+        for (size_t i = 0; i < strValue.size() && (index + i) < memMap.getWindowSize(); ++i) {
+            memMap.writeElement(index + i, std::string(1, strValue[i]));
+        }
+    } 
+    else {
+        memMap.writeElement(index, value);
+    }
+}
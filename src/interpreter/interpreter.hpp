@@ -4,16 +4,19 @@
 
 #include <iostream>
 #include <unordered_map>
+#include <algorithm>
 #include <array>
+#include <cstdint>
+#include <bitset>
 #include <variant>
 #include <string>
 #include <memory>
 #include <vector>
 #include <fstream>
 #include "../ast/ast.hpp"
-
-// 値の型
-using Value = std::variant<int, double, std::string, bool>;
+#include "../jit/jit.hpp"
+#include "../writer/writer.hpp"
+#include "../reader/reader.hpp"
 
 // メモリプールのサイズ
 constexpr size_t MEMORY_POOL_SIZE = 64;
@@ -24,19 +27,88 @@ constexpr size_t SYSTEM_START = 60;
 // スタックのサイズ
 constexpr size_t STACK_MAX_SIZE = 1024;
 
-// メモリマップのサイズ
+// メモリマップのウィンドウの既定の要素数（--map-window で変えられる）
 constexpr size_t MEMORY_MAP_SIZE = 1024;
 
+// ファイルのページごとの印（1ページ1bit。走査は印を付けた語の範囲に限る）
+class PageBitmap {
+private:
+    std::vector<uint64_t> words;
+    size_t first = 0; // 印のある語の範囲 [first, last)
+    size_t last = 0;
+
+public:
+    bool empty() const { return first == last; }
+    // firstPage〜lastPage に印を付ける
+    void mark(size_t firstPage, size_t lastPage);
+    // 別のビットマップの印を加える
+    void merge(const PageBitmap& other);
+    void clear();
+
+    // 印の付いたページの連続した範囲ごとに visit(先頭のページ, ページ数) を呼ぶ（limit 以降のページは除く）
+    template <typename Visit>
+    void forEachRun(size_t limit, Visit visit) const {
+        size_t end = std::min(last * 64, limit);
+        size_t page = first * 64;
+        while (page < end) {
+            uint64_t word = words[page / 64] >> (page % 64);
+            if (word == 0) {
+                page = (page / 64 + 1) * 64; // 印のない残りは丸ごと飛ばす
+                continue;
+            }
+            if (!(word & 1)) {
+                ++page;
+                continue;
+            }
+            size_t start = page;
+            while (page < end && (words[page / 64] >> (page % 64) & 1)) {
+                ++page;
+            }
+            visit(start, page - start);
+        }
+    }
+};
+
 // メモリマップ管理クラス
+// ファイル全体を mmap(MAP_SHARED) でマップし、要素の読み書きはメモリへのロード・ストアで行う
+// 書き込んだページはビットマップに記録し、ウィンドウスライド・破棄時に連続したページごとにまとめて msync で反映を始める
+// 同期文 <<; では反映を始めたページも含めてディスクへの書き込みまで待つ（ファイル全体は msync しない）
+// mmap のない環境（POSIX以外）では、読み書きのたびにファイルを開いて読み書きする
 class MemoryMap {
 private:
     std::string filePath;
-    size_t windowOffset;
+    size_t windowOffset;    // ウィンドウの先頭の要素番号（64bit）
+    size_t windowSize = MEMORY_MAP_SIZE; // ウィンドウの要素数
     char mapType; // '#', '@', '~', '%'
+    int fd = -1;            // マップしているファイル（mmap を使うときのみ）
+    char* data = nullptr;   // マッピングの先頭（mmap を使うときのみ）
+    size_t mappedSize = 0;  // マッピングのバイト数（伸ばすたびに作り直さないよう倍々に余裕を持たせる）
+    size_t fileSize = 0;    // ファイルのバイト数（これより先の要素は読むと0）
+    PageBitmap dirtyPages;    // 前回の同期以降に書き込んだページ
+    PageBitmap flushingPages; // 反映を始めたが、ディスクへの書き込みを待っていないページ
+
+    // ファイルを開いてマップする・マッピングを解除してファイルを閉じる
+    void open();
+    void close();
+    // 現在のファイルサイズに合わせてマップし直す
+    void remap();
+    // ファイルの offset から size バイトを読む（ファイルの終端より先は0）
+    void readBytes(size_t offset, size_t size, void* out) const;
+    // ファイルの offset から size バイトを書く（ファイルの終端より先なら書いた位置までファイルを伸ばす）
+    void writeBytes(size_t offset, size_t size, const void* in);
+    // ファイルの [offset, end) を含むページに書き込みの印を付ける
+    void markDirty(size_t offset, size_t end);
+    // 印の付いたページを連続した範囲ごとに msync する（失敗があればfalse）
+    bool flushPages(const PageBitmap& pages, int flags);
     
 public:
     MemoryMap() : windowOffset(0), mapType('\0') {}
-    MemoryMap(const std::string& path, char type) : filePath(path), windowOffset(0), mapType(type) {}
+    MemoryMap(const std::string& path, char type) : windowOffset(0), mapType('\0') { mapFile(path, type); }
+    ~MemoryMap() { close(); }
+    MemoryMap(MemoryMap&& other) noexcept;
+    MemoryMap& operator=(MemoryMap&& other) noexcept;
+    MemoryMap(const MemoryMap&) = delete;
+    MemoryMap& operator=(const MemoryMap&) = delete;
     
     // ファイルマッピング
     void mapFile(const std::string& path, char type);
@@ -44,27 +116,53 @@ public:
     // 要素の読み書き
     Value readElement(size_t index);
     void writeElement(size_t index, const Value& value);
+
+    // ウィンドウ内の連続した要素を格納形式のまままとめて読み書き（'#'・'~'はint32_t・float）
+    void readBlock(size_t index, size_t count, void* data);
+    void writeBlock(size_t index, size_t count, const void* data);
+    size_t elementSize() const;
     
-    // ウィンドウスライド
-    void slideWindow(int offset);
+    // ウィンドウスライド（0未満にはならず、ファイルのオフセットが表せない位置へは例外）
+    void slideWindow(long long offset);
+
+    // ウィンドウの要素数を変える（マップ中でもよい）
+    void setWindowSize(size_t size);
     
     // ファイル初期化・拡張
     void ensureFileSize();
+
+    // ファイル全体の要素数（ウィンドウの位置によらない）
+    size_t elementCount() const { return fileSize / elementSize(); }
+
+    // 書き込んだ内容をファイルに反映する（waitならディスクへの書き込みまで待つ）
+    void sync(bool wait);
+    // ファイルが外から書き換えられたときにマップし直す
+    void reload();
+
+    // 保存しておいた状態に戻す（パスが空なら未マップ）
+    void restore(const std::string& path, char type, size_t offset);
     
     // getter
     bool isMapped() const { return !filePath.empty(); }
     size_t getWindowOffset() const { return windowOffset; }
+    size_t getWindowSize() const { return windowSize; }
     const std::string& getFilePath() const { return filePath; }
     char getMapType() const { return mapType; }
 };
 
 class Interpreter {
+    // バイトコードVM・クロージャエンジンは同じマシン状態の上で動作する
+    friend class VirtualMachine;
+    friend class ClosureCompiler;
+    // スナップショットはマシン状態をまるごと読み書きする
+    friend class StateSnapshot;
+
 private:
-    // 各型のメモリプール
-    std::array<Value, MEMORY_POOL_SIZE> intPool;    // # (整数)
-    std::array<Value, MEMORY_POOL_SIZE> stringPool; // @ (文字列)
-    std::array<Value, MEMORY_POOL_SIZE> floatPool;  // ~ (浮動小数点)
-    std::array<Value, MEMORY_POOL_SIZE> boolPool;   // % (真偽値)
+    // 各型のメモリプール（型ごとに値をそのまま格納）
+    std::array<int, MEMORY_POOL_SIZE> intPool;            // # (整数)
+    std::array<std::string, MEMORY_POOL_SIZE> stringPool; // @ (文字列)
+    std::array<double, MEMORY_POOL_SIZE> floatPool;       // ~ (浮動小数点)
+    std::bitset<MEMORY_POOL_SIZE> boolPool;               // % (真偽値)
 
     // 各型のスタック
     std::vector<int> intStack;
@@ -74,27 +172,51 @@ private:
 
     // 関数テーブル
     std::unordered_map<int, std::shared_ptr<ASTNode>> functions;
+    uint64_t functionsVersion = 0; // 関数が定義されるたびに増える
+
+    // ループのJIT
+    LoopJit jit;
+    bool jitEnabled = LoopJit::available();
+
+    // コンパイル済みのループを実行
+    void runNativeLoop(JitFunction function);
     
+    // 入出力先（既定は標準入出力）
+    OutputWriter output{std::cout};
+    std::istream* input = &std::cin;
+
+    // 入力文の読み方（端末なら入力を促して1語ずつ、それ以外はバッファから読む）
+    bool inputPrompt = InputReader::isTerminal(std::cin);
+    std::unique_ptr<InputReader> inputReader; // 最初の読み込みで作る
+    std::string inputToken;                   // 読み込んだ語（使い回す）
+
+    // バッファから入力文の値を読んでスロットに入れる
+    void readBufferedInput(char memType, int index, const std::string& varName);
+
+    // 埋め込み先が結び付けるデータ（ネイティブ関数から参照する）
+    void* host = nullptr;
+
     // メモリマップ
     MemoryMap intMemoryMap;    // ^#
     MemoryMap stringMemoryMap; // ^@
     MemoryMap floatMemoryMap;  // ^~
     MemoryMap boolMemoryMap;   // ^%
     
-    // メモリ参照を解決する
-    Value resolveMemoryRef(const std::string& ref);
-    int evaluateMemoryIndex(const std::string& indexExpr);
-    
-    // 値を文字列に変換
-    static std::string valueToString(const Value& val);
+    // メモリ参照のインデックスを解決する（ネストされた参照を内側から辿る）
+    int resolveMemoryIndex(const MemoryDescriptor& mem);
+
+    // メモリプールのインデックス検査
+    static void checkPoolIndex(int index) {
+        if (index < 0 || index >= static_cast<int>(MEMORY_POOL_SIZE)) {
+            throw std::out_of_range("Memory index out of range: " + std::to_string(index));
+        }
+    }
 
 public:
     Interpreter(){
         // メモリプールの初期化
         intPool.fill(0);
-        stringPool.fill("");
         floatPool.fill(0.0);
-        boolPool.fill(false);
 
         // スタックの初期化
         intStack.reserve(STACK_MAX_SIZE);
@@ -104,15 +226,66 @@ public:
     }
     ~Interpreter() = default;
     
+    // 入出力先を差し替える
+    void setOutput(std::ostream& stream) { output.setStream(stream); }
+    void setInput(std::istream& stream) {
+        input = &stream;
+        inputReader.reset();
+        inputPrompt = InputReader::isTerminal(stream);
+    }
+    // 入力を促すかを切り替える（setInput の後に呼ぶ）
+    void setInputPrompt(bool enabled) { inputPrompt = enabled; }
+    // 入力元のバッファ（入力文と -n の行の読み込みで共有する）
+    InputReader& getInputReader() {
+        if (!inputReader) {
+            inputReader = std::make_unique<InputReader>(*input);
+        }
+        return *inputReader;
+    }
+    OutputWriter& getOutput() { return output; }
+
+    // 出力文の値を1行書く（各実行エンジンで共有）
+    void writeLine(const Value& value);
+    // 溜めた出力を流す
+    void flushOutput() { output.flush(); }
+
+    // 埋め込み先のデータ
+    void setHost(void* data) { host = data; }
+    void* getHost() const { return host; }
+
+    // マシン状態（プール・スタック・関数・メモリマップ）を初期状態に戻す
+    void reset();
+    // ループのJITの実行状況を捨てる（別のプログラムを実行する前に呼ぶ）
+    void clearJit() { jit.clear(); }
+
+    // スタック本体（ネイティブ関数がまとめて操作する）
+    std::vector<int>& getIntStack() { return intStack; }
+    std::vector<double>& getFloatStack() { return floatStack; }
+
+    // メモリプールの先頭（ホストから直接読み書きする）
+    int* intSlots() { return intPool.data(); }
+    double* floatSlots() { return floatPool.data(); }
+
+    // 定義済みの関数（ID順）
+    std::vector<std::shared_ptr<ASTNode>> definedFunctions() const;
+
+    // スタックの要素数
+    size_t stackSize(char type) const;
+
+    // ループのJITを有効・無効にする
+    void setJitEnabled(bool enabled) { jitEnabled = enabled && LoopJit::available(); }
+
     // 実行
     void interpret(const std::shared_ptr<ASTNode>& program);
     
     // 評価
     Value evaluateNode(const std::shared_ptr<ASTNode>& node);
+    const Value& evaluateOperand(const std::shared_ptr<ASTNode>& node, Value& temp);
     Value evaluateProgram(const std::shared_ptr<ASTNode>& program);
     Value evaluateFunction(const std::shared_ptr<ASTNode>& node);
     Value evaluateFunctionCall(const std::shared_ptr<ASTNode>& node);
     Value evaluateAssignment(const std::shared_ptr<ASTNode>& node);
+    Value evaluateCompoundAssignment(const std::shared_ptr<ASTNode>& node);
     Value evaluateArithmeticExpression(const std::shared_ptr<ASTNode>& node);
     Value evaluateLogicalExpression(const std::shared_ptr<ASTNode>& node);
     Value evaluateMemoryRef(const std::shared_ptr<ASTNode>& node);
@@ -136,7 +309,38 @@ public:
     // 変数の取得と設定
     Value getMemoryValue(char type, int index);
     void setMemoryValue(char type, int index, const Value& value);
+
+    // 型付きの変数アクセス
+    int getInt(int index) const { checkPoolIndex(index); return intPool[index]; }
+    double getFloat(int index) const { checkPoolIndex(index); return floatPool[index]; }
+    const std::string& getString(int index) const { checkPoolIndex(index); return stringPool[index]; }
+    bool getBool(int index) const { checkPoolIndex(index); return boolPool[index]; }
+    void setInt(int index, int value) { checkPoolIndex(index); intPool[index] = value; }
+    void setFloat(int index, double value) { checkPoolIndex(index); floatPool[index] = value; }
+    void setString(int index, std::string value) { checkPoolIndex(index); stringPool[index] = std::move(value); }
+    void setBool(int index, bool value) { checkPoolIndex(index); boolPool[index] = value; }
+    
+    // スタック操作
+    void pushStack(char type, const Value& value);
+    Value popStack(char type);
     
     // メモリマップの取得
     MemoryMap& getMemoryMap(char type);
+    // すべてのメモリマップのウィンドウの要素数を変える
+    void setMapWindowSize(size_t size);
+
+    // メモリマップ要素の読み書き
+    Value readMemoryMap(char mapType, size_t index);
+    void writeMemoryMap(char mapType, size_t index, const Value& value);
+    // すべてのメモリマップをファイルに同期する（同期文 <<;）
+    void syncMemoryMaps();
+
+    // 値を文字列に変換
+    static std::string valueToString(const Value& val);
+
+    // 値に対する演算（各実行エンジンで共有）
+    static Value applyArithmetic(Operator op, const Value& left, const Value& right);
+    static Value applyComparison(Operator op, const Value& left, const Value& right);
+    static Value applyCast(Operator targetType, const Value& value);
+    static Value applyCharCodeCast(Operator castType, const Value& value);
 };
@@ -0,0 +1,386 @@
+// SigNum Loop JIT (x86-64)
+
+#include "jit.hpp"
+#include <cstring>
+#include <initializer_list>
+#include <string>
+
+#if defined(__x86_64__) && defined(__linux__)
+#define SIGNUM_JIT_X86_64 1
+#include <sys/mman.h>
+#endif
+
+namespace {
+
+// 添字が静的な単純参照か
+bool isStaticSlot(const std::shared_ptr<ASTNode>& node, char type) {
+    const MemoryDescriptor& mem = node->memory;
+    return node->type == NodeType::MemoryRef && mem.valid && !mem.isMap && mem.type == type &&
+           mem.indirection.empty() && mem.index >= 0 && mem.index < 64;
+}
+
+// x86-64の機械語を生成する
+// 規約: rbx = intプール, r12 = boolプールのビット列, 式の結果はeax
+class CodeGenerator {
+private:
+    const FunctionTable& functions;
+    std::vector<int> inlining;             // インライン展開中の関数ID
+    std::vector<size_t> divisionErrors;    // ゼロ除算へのジャンプ
+    std::vector<size_t> moduloErrors;      // ゼロ剰余へのジャンプ
+
+    void emit(std::initializer_list<uint8_t> bytes) {
+        code.insert(code.end(), bytes);
+    }
+    void emit32(int32_t value) {
+        uint8_t bytes[4];
+        std::memcpy(bytes, &value, 4);
+        code.insert(code.end(), bytes, bytes + 4);
+    }
+    // rel32のジャンプ（飛び先は後で書き換える）
+    size_t emitJump(std::initializer_list<uint8_t> opcode) {
+        emit(opcode);
+        emit32(0);
+        return code.size() - 4;
+    }
+    void patch(size_t at, size_t target) {
+        int32_t rel = static_cast<int32_t>(target) - static_cast<int32_t>(at + 4);
+        std::memcpy(&code[at], &rel, 4);
+    }
+
+    // 二項演算の被演算子（左をeax、右をecxに置く）
+    template <typename F>
+    bool binaryOperands(const std::shared_ptr<ASTNode>& node, F generate) {
+        if (!generate(node->children[0])) return false;
+        emit({0x50});              // push rax
+        if (!generate(node->children[1])) return false;
+        emit({0x89, 0xC1});        // mov ecx, eax
+        emit({0x58});              // pop rax
+        return true;
+    }
+
+public:
+    std::vector<uint8_t> code;
+
+    CodeGenerator(const FunctionTable& functions) : functions(functions) {}
+
+    // int式
+    bool generateInt(const std::shared_ptr<ASTNode>& node) {
+        switch (node->type) {
+            case NodeType::Number:
+            case NodeType::Constant:
+                if (!node->constant || !std::holds_alternative<int>(*node->constant)) return false;
+                emit({0xB8});      // mov eax, imm32
+                emit32(std::get<int>(*node->constant));
+                return true;
+
+            case NodeType::MemoryRef:
+                if (!isStaticSlot(node, '#')) return false;
+                emit({0x8B, 0x83}); // mov eax, [rbx + disp32]
+                emit32(node->memory.index * 4);
+                return true;
+
+            case NodeType::ArithmeticExpression: {
+                if (node->children.size() == 1) {
+                    return generateInt(node->children[0]);
+                }
+                if (node->children.size() != 2) return false;
+                if (!binaryOperands(node, [this](const auto& child) { return generateInt(child); })) {
+                    return false;
+                }
+                switch (node->op) {
+                    case Operator::Add: emit({0x01, 0xC8}); return true;       // add eax, ecx
+                    case Operator::Subtract: emit({0x29, 0xC8}); return true;  // sub eax, ecx
+                    case Operator::Multiply: emit({0x0F, 0xAF, 0xC1}); return true; // imul eax, ecx
+                    case Operator::Divide:
+                        emit({0x85, 0xC9}); // test ecx, ecx
+                        divisionErrors.push_back(emitJump({0x0F, 0x84})); // jz
+                        emit({0x99, 0xF7, 0xF9}); // cdq; idiv ecx
+                        return true;
+                    case Operator::Modulus:
+                        emit({0x85, 0xC9});
+                        moduloErrors.push_back(emitJump({0x0F, 0x84}));
+                        emit({0x99, 0xF7, 0xF9});
+                        emit({0x89, 0xD0}); // mov eax, edx
+                        return true;
+                    default:
+                        return false;
+                }
+            }
+
+            default:
+                return false;
+        }
+    }
+
+    // bool式（eaxに0/1）
+    bool generateBool(const std::shared_ptr<ASTNode>& node) {
+        switch (node->type) {
+            case NodeType::Constant:
+                if (!std::holds_alternative<bool>(*node->constant)) return false;
+                emit({0xB8});
+                emit32(std::get<bool>(*node->constant) ? 1 : 0);
+                return true;
+
+            case NodeType::MemoryRef:
+                if (!isStaticSlot(node, '%')) return false;
+                emit({0x49, 0x8B, 0x04, 0x24}); // mov rax, [r12]
+                if (node->memory.index > 0) {
+                    emit({0x48, 0xC1, 0xE8, static_cast<uint8_t>(node->memory.index)}); // shr rax, imm8
+                }
+                emit({0x83, 0xE0, 0x01}); // and eax, 1
+                return true;
+
+            case NodeType::Comparison: {
+                if (node->children.size() != 2) return false;
+                if (!binaryOperands(node, [this](const auto& child) { return generateInt(child); })) {
+                    return false;
+                }
+                uint8_t setcc;
+                switch (node->op) {
+                    case Operator::Equal: setcc = 0x94; break;
+                    case Operator::NotEqual: setcc = 0x95; break;
+                    case Operator::Less: setcc = 0x9C; break;
+                    case Operator::LessEqual: setcc = 0x9E; break;
+                    case Operator::Greater: setcc = 0x9F; break;
+                    case Operator::GreaterEqual: setcc = 0x9D; break;
+                    default: return false;
+                }
+                emit({0x39, 0xC8});              // cmp eax, ecx
+                emit({0x0F, setcc, 0xC0});       // setcc al
+                emit({0x0F, 0xB6, 0xC0});        // movzx eax, al
+                return true;
+            }
+
+            case NodeType::LogicalExpression: {
+                if (node->children.size() == 1) {
+                    if (!generateBool(node->children[0])) return false;
+                    if (node->op == Operator::Not) {
+                        emit({0x83, 0xF0, 0x01}); // xor eax, 1
+                    }
+                    return true;
+                }
+                if (node->children.size() != 2) return false;
+                if (!binaryOperands(node, [this](const auto& child) { return generateBool(child); })) {
+                    return false;
+                }
+                // ツリーウォーカーと同じく両辺とも評価済み
+                switch (node->op) {
+                    case Operator::And: emit({0x21, 0xC8}); return true; // and eax, ecx
+                    case Operator::Or: emit({0x09, 0xC8}); return true;  // or eax, ecx
+                    default: return false;
+                }
+            }
+
+            default:
+                return false;
+        }
+    }
+
+    // 文
+    bool generateStatement(const std::shared_ptr<ASTNode>& node) {
+        switch (node->type) {
+            case NodeType::Statement:
+                for (const auto& child : node->children) {
+                    if (!generateStatement(child)) return false;
+                }
+                return true;
+
+            case NodeType::Assignment: {
+                if (node->children.size() < 2) return false;
+                const auto& target = node->children[0];
+                if (isStaticSlot(target, '#')) {
+                    if (!generateInt(node->children[1])) return false;
+                    emit({0x89, 0x83}); // mov [rbx + disp32], eax
+                    emit32(target->memory.index * 4);
+                    return true;
+                }
+                if (isStaticSlot(target, '%')) {
+                    if (!generateBool(node->children[1])) return false;
+                    uint8_t bit = static_cast<uint8_t>(target->memory.index);
+                    emit({0x49, 0x8B, 0x0C, 0x24});       // mov rcx, [r12]
+                    emit({0x48, 0x0F, 0xBA, 0xF1, bit});  // btr rcx, imm8
+                    if (bit > 0) {
+                        emit({0x48, 0xC1, 0xE0, bit});    // shl rax, imm8
+                    }
+                    emit({0x48, 0x09, 0xC1});             // or rcx, rax
+                    emit({0x49, 0x89, 0x0C, 0x24});       // mov [r12], rcx
+                    return true;
+                }
+                return false;
+            }
+
+            case NodeType::IfStatement: {
+                const auto& children = node->children;
+                if (children.size() < 2) return false;
+                std::vector<size_t> endJumps;
+                // 2つ置きに条件と本体、最後の1つはelse
+                for (size_t i = 0; i < children.size(); i += 2) {
+                    if (i == children.size() - 1) {
+                        if (!generateStatement(children[i])) return false;
+                        break;
+                    }
+                    if (!generateBool(children[i])) return false;
+                    emit({0x85, 0xC0}); // test eax, eax
+                    size_t skip = emitJump({0x0F, 0x84}); // jz
+                    if (!generateStatement(children[i + 1])) return false;
+                    endJumps.push_back(emitJump({0xE9})); // jmp
+                    patch(skip, code.size());
+                }
+                for (size_t jump : endJumps) {
+                    patch(jump, code.size());
+                }
+                return true;
+            }
+
+            case NodeType::LoopStatement:
+                return generateLoop(node);
+
+            case NodeType::FunctionCall: {
+                int id = std::stoi(node->value);
+                auto it = functions.find(id);
+                if (it == functions.end()) return false;
+                // 再帰呼び出しは展開しない
+                for (int active : inlining) {
+                    if (active == id) return false;
+                }
+                inlining.push_back(id);
+                for (const auto& child : it->second->children) {
+                    if (!generateStatement(child)) return false;
+                }
+                inlining.pop_back();
+                return true;
+            }
+
+            default:
+                return false;
+        }
+    }
+
+    // ループ（条件がfalseのときだけ抜ける）
+    bool generateLoop(const std::shared_ptr<ASTNode>& node) {
+        if (node->children.size() < 2) return false;
+        size_t top = code.size();
+        if (!generateBool(node->children[0])) return false;
+        emit({0x85, 0xC0}); // test eax, eax
+        size_t exit = emitJump({0x0F, 0x84}); // jz
+        if (!generateStatement(node->children[1])) return false;
+        size_t back = emitJump({0xE9}); // jmp
+        patch(back, top);
+        patch(exit, code.size());
+        return true;
+    }
+
+    // 関数全体
+    bool generateFunction(const std::shared_ptr<ASTNode>& loop) {
+        emit({0x53});             // push rbx
+        emit({0x41, 0x54});       // push r12
+        emit({0x48, 0x89, 0xFB}); // mov rbx, rdi
+        emit({0x49, 0x89, 0xF4}); // mov r12, rsi
+        if (!generateLoop(loop)) return false;
+
+        emit({0x31, 0xC0}); // xor eax, eax
+        size_t epilogue = code.size();
+        emit({0x41, 0x5C}); // pop r12
+        emit({0x5B});       // pop rbx
+        emit({0xC3});       // ret
+
+        // エラー出口
+        size_t divisionError = code.size();
+        emit({0xB8});
+        emit32(static_cast<int32_t>(JitStatus::DivisionByZero));
+        patch(emitJump({0xE9}), epilogue);
+        size_t moduloError = code.size();
+        emit({0xB8});
+        emit32(static_cast<int32_t>(JitStatus::ModuloByZero));
+        patch(emitJump({0xE9}), epilogue);
+
+        for (size_t jump : divisionErrors) patch(jump, divisionError);
+        for (size_t jump : moduloErrors) patch(jump, moduloError);
+        return true;
+    }
+};
+
+} // namespace
+
+LoopJit::~LoopJit() {
+    clear();
+}
+
+// 実行状況とネイティブコードをすべて捨てる
+void LoopJit::clear() {
+#ifdef SIGNUM_JIT_X86_64
+    for (const auto& region : regions) {
+        munmap(region.first, region.second);
+    }
+#endif
+    regions.clear();
+    profiles.clear();
+}
+
+// このプラットフォームでJITが使えるか
+bool LoopJit::available() {
+#ifdef SIGNUM_JIT_X86_64
+    return true;
+#else
+    return false;
+#endif
+}
+
+// ループの実行状況を取得
+LoopJit::Profile& LoopJit::profile(const std::shared_ptr<ASTNode>& loop) {
+    Profile& entry = profiles[loop.get()];
+    if (entry.loop.lock() != loop) {
+        entry = Profile();
+        entry.loop = loop;
+    }
+    return entry;
+}
+
+// 1反復を数え、ホットになったらネイティブコードを返す
+JitFunction LoopJit::countIteration(Profile& profile, const std::shared_ptr<ASTNode>& loop,
+                                    const FunctionTable& functions, uint64_t functionsVersion) {
+    // 関数が定義し直されていたらやり直す
+    if (profile.functionsVersion != functionsVersion) {
+        profile.hotness = 0;
+        profile.rejected = false;
+        profile.function = nullptr;
+        profile.functionsVersion = functionsVersion;
+    }
+    if (profile.function) {
+        return profile.function;
+    }
+    if (profile.rejected || ++profile.hotness < JIT_HOT_THRESHOLD) {
+        return nullptr;
+    }
+
+    profile.function = compile(loop, functions);
+    profile.rejected = (profile.function == nullptr);
+    return profile.function;
+}
+
+// ネイティブコードをコンパイル
+JitFunction LoopJit::compile(const std::shared_ptr<ASTNode>& loop, const FunctionTable& functions) {
+#ifdef SIGNUM_JIT_X86_64
+    CodeGenerator generator(functions);
+    if (!generator.generateFunction(loop)) {
+        return nullptr;
+    }
+
+    size_t size = generator.code.size();
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        return nullptr;
+    }
+    std::memcpy(memory, generator.code.data(), size);
+    if (mprotect(memory, size, PROT_READ | PROT_EXEC) != 0) {
+        munmap(memory, size);
+        return nullptr;
+    }
+    regions.emplace_back(memory, size);
+    return reinterpret_cast<JitFunction>(memory);
+#else
+    (void)loop;
+    (void)functions;
+    return nullptr;
+#endif
+}
@@ -0,0 +1,68 @@
+// SigNum Loop JIT (x86-64)
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "../ast/ast.hpp"
+
+// ループをネイティブコードにコンパイルするまでの反復回数
+constexpr uint32_t JIT_HOT_THRESHOLD = 1000;
+
+// ネイティブコードの戻り値
+enum class JitStatus : int {
+    Done = 0,           // ループ条件がfalseになって終了
+    DivisionByZero = 1, // ゼロ除算
+    ModuloByZero = 2    // ゼロ剰余
+};
+
+// コンパイルされたループ（intプールとboolプールのビット列を受け取る）
+using JitFunction = int (*)(int* intPool, uint64_t* boolBits);
+
+// 関数テーブル（Interpreterと同じ形）
+using FunctionTable = std::unordered_map<int, std::shared_ptr<ASTNode>>;
+
+// 整数ループ用のテンプレートJIT
+// intプール・boolプールの読み書き、算術演算、比較、条件分岐、ループ、
+// JIT可能な関数の呼び出し（インライン展開）だけでできたループを対象とする
+class LoopJit {
+public:
+    // ループごとの実行状況
+    struct Profile {
+        uint32_t hotness = 0;           // 反復回数
+        bool rejected = false;          // コンパイルできなかった
+        uint64_t functionsVersion = 0;  // コンパイル時の関数テーブルの版
+        JitFunction function = nullptr;
+        std::weak_ptr<const ASTNode> loop; // 記録したループ（解放されたノードと同じアドレスの別のループと区別する）
+    };
+
+private:
+    std::unordered_map<const ASTNode*, Profile> profiles;
+    std::vector<std::pair<void*, size_t>> regions; // 確保した実行可能領域
+
+    // ネイティブコードをコンパイル（できなければnullptr）
+    JitFunction compile(const std::shared_ptr<ASTNode>& loop, const FunctionTable& functions);
+
+public:
+    LoopJit() = default;
+    LoopJit(const LoopJit&) = delete;
+    LoopJit& operator=(const LoopJit&) = delete;
+    ~LoopJit();
+
+    // このプラットフォームでJITが使えるか
+    static bool available();
+
+    // 実行状況とネイティブコードをすべて捨てる（ループの実行中には呼ばない）
+    void clear();
+
+    // ループの実行状況を取得（参照は無効にならない）
+    // 同じアドレスに前のプログラムの解放されたループが記録されていれば、その状況は捨てて新しく数え直す
+    Profile& profile(const std::shared_ptr<ASTNode>& loop);
+
+    // 1反復を数え、ホットになったらネイティブコードを返す
+    JitFunction countIteration(Profile& profile, const std::shared_ptr<ASTNode>& loop,
+                               const FunctionTable& functions, uint64_t functionsVersion);
+};
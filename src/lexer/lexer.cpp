@@ -523,9 +523,9 @@ std::vector<Token> Lexer::tokenize() {
 }
 
 // エラー情報を出力
-void Lexer::printErrors() const {
+void Lexer::printErrors(std::ostream& out) const {
     for (const auto& error : errors) {
-        std::cerr << error.toString() << std::endl;
+        out << error.toString() << std::endl;
     }
 }
 
@@ -49,7 +49,7 @@ public:
     // エラー関連
     bool hasErrors() const { return !errors.empty(); }
     const std::vector<LexerError>& getErrors() const { return errors; }
-    void printErrors() const;
+    void printErrors(std::ostream& out = std::cerr) const;
 
     void reset() {
         pos = 0;
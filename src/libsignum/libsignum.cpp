@@ -0,0 +1,246 @@
+// SigNum Embedding API (libsignum)
+
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include "libsignum.h"
+#include "../lexer/lexer.hpp"
+#include "../parser/parser.hpp"
+#include "../semantic/semantic.hpp"
+#include "../optimizer/optimizer.hpp"
+#include "../interpreter/interpreter.hpp"
+#include "../native/native.hpp"
+
+static_assert(SG_POOL_SIZE == MEMORY_POOL_SIZE && SG_ARGS_START == ARGS_START &&
+              SG_RETURN_START == RETURN_START && SG_SYSTEM_START == SYSTEM_START,
+              "libsignum.h is out of sync with interpreter.hpp");
+static_assert(SG_NATIVE_START == NATIVE_FUNCTION_START && SG_NATIVE_END == NATIVE_FUNCTION_END,
+              "libsignum.h is out of sync with native.hpp");
+
+namespace {
+
+thread_local std::string lastError;
+
+// 出力をホストのコールバックに渡すストリームバッファ
+class SinkBuffer : public std::streambuf {
+private:
+    sg_output_fn output = nullptr;
+    void* user = nullptr;
+    char buffer[4096];
+
+    void flushBuffer() {
+        if (pptr() > pbase()) {
+            output(user, pbase(), static_cast<size_t>(pptr() - pbase()));
+        }
+        setp(buffer, buffer + sizeof(buffer));
+    }
+
+protected:
+    int_type overflow(int_type c) override {
+        flushBuffer();
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    int sync() override {
+        flushBuffer();
+        return 0;
+    }
+
+    // まとまった出力はバッファを通さずに渡す
+    std::streamsize xsputn(const char* data, std::streamsize count) override {
+        flushBuffer();
+        if (count > 0) {
+            output(user, data, static_cast<size_t>(count));
+        }
+        return count;
+    }
+
+public:
+    SinkBuffer(sg_output_fn output, void* user) : output(output), user(user) {
+        setp(buffer, buffer + sizeof(buffer));
+    }
+};
+
+// 範囲外のスロットならエラーを記録する
+bool checkSlot(int slot) {
+    if (slot < 0 || slot >= static_cast<int>(MEMORY_POOL_SIZE)) {
+        lastError = "Memory index out of range: " + std::to_string(slot);
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+struct sg_program {
+    std::shared_ptr<const ASTNode> ast;
+};
+
+struct sg_context {
+    Interpreter interpreter;
+    std::unique_ptr<SinkBuffer> sink;
+    std::unique_ptr<std::ostream> stream;
+    std::unique_ptr<std::istringstream> input;
+    // 最後に実行したプログラム（JITの実行状況はASTのアドレスで引くので、
+    // 別のプログラムに切り替えるときは捨てる）
+    std::shared_ptr<const ASTNode> lastProgram;
+};
+
+const char* sg_last_error(void) {
+    return lastError.c_str();
+}
+
+sg_program* sg_compile(const char* source, size_t length) {
+    try {
+        Lexer lexer(std::string(source, length));
+        auto tokens = lexer.tokenize();
+        if (lexer.hasErrors()) {
+            lastError = lexer.getErrors().front().toString();
+            return nullptr;
+        }
+        Parser parser(tokens);
+        auto ast = parser.parseProgram();
+        if (!ast || parser.hasErrors()) {
+            lastError = parser.hasErrors() ? parser.getErrors().front() : "Parsing failed";
+            return nullptr;
+        }
+        SemanticAnalyzer semanticAnalyzer;
+        semanticAnalyzer.setVerbose(false);
+        if (!semanticAnalyzer.analyze(ast)) {
+            lastError = "Semantic error: " + semanticAnalyzer.getErrors().front();
+            return nullptr;
+        }
+        Optimizer optimizer;
+        return new sg_program{optimizer.optimize(ast)};
+    }
+    catch (const std::exception& e) {
+        lastError = e.what();
+        return nullptr;
+    }
+}
+
+void sg_program_free(sg_program* program) {
+    delete program;
+}
+
+sg_context* sg_context_new(void) {
+    try {
+        sg_context* context = new sg_context();
+        context->interpreter.setHost(context);
+        return context;
+    }
+    catch (const std::exception& e) {
+        lastError = e.what();
+        return nullptr;
+    }
+}
+
+void sg_context_free(sg_context* context) {
+    // 出力先のストリームはInterpreterより先に破棄されるので、溜めた出力をここで流す
+    if (context) {
+        context->interpreter.flushOutput();
+    }
+    delete context;
+}
+
+void sg_context_reset(sg_context* context) {
+    context->interpreter.reset();
+}
+
+void sg_context_set_output(sg_context* context, sg_output_fn output, void* user) {
+    context->interpreter.flushOutput();
+    if (!output) {
+        context->interpreter.setOutput(std::cout);
+        context->stream.reset();
+        context->sink.reset();
+        return;
+    }
+    context->sink = std::make_unique<SinkBuffer>(output, user);
+    context->stream = std::make_unique<std::ostream>(context->sink.get());
+    context->interpreter.setOutput(*context->stream);
+}
+
+void sg_set_input(sg_context* context, const char* data, size_t length) {
+    if (!data) {
+        context->interpreter.setInput(std::cin);
+        context->input.reset();
+        return;
+    }
+    // 前の入力は、読み込みバッファが新しい入力に切り替わってから破棄する
+    auto input = std::make_unique<std::istringstream>(std::string(data, length));
+    context->interpreter.setInput(*input);
+    context->input = std::move(input);
+}
+
+int sg_register_native(int id, sg_native_fn function, void* user) {
+    try {
+        if (!function) {
+            NativeRegistry::remove(id);
+            return SG_OK;
+        }
+        NativeRegistry::add(id, [function, user](Interpreter& interpreter) {
+            function(static_cast<sg_context*>(interpreter.getHost()), user);
+        });
+        return SG_OK;
+    }
+    catch (const std::exception& e) {
+        lastError = e.what();
+        return SG_ERROR;
+    }
+}
+
+int sg_run(sg_context* context, const sg_program* program) {
+    int status = SG_OK;
+    if (context->lastProgram != program->ast) {
+        context->interpreter.clearJit();
+        context->lastProgram = program->ast;
+    }
+    try {
+        // ASTは共有したまま使う（実行中に書き換わる特殊化の状態はatomicなので、他のスレッドと同時に実行してもよい）
+        context->interpreter.interpret(std::const_pointer_cast<ASTNode>(program->ast));
+    }
+    catch (const std::exception& e) {
+        lastError = e.what();
+        status = SG_ERROR;
+    }
+    context->interpreter.flushOutput();
+    return status;
+}
+
+int* sg_int_pool(sg_context* context) {
+    return context->interpreter.intSlots();
+}
+
+double* sg_float_pool(sg_context* context) {
+    return context->interpreter.floatSlots();
+}
+
+int sg_get_bool(const sg_context* context, int slot, int* value) {
+    if (!checkSlot(slot)) return SG_ERROR;
+    *value = context->interpreter.getBool(slot) ? 1 : 0;
+    return SG_OK;
+}
+
+int sg_set_bool(sg_context* context, int slot, int value) {
+    if (!checkSlot(slot)) return SG_ERROR;
+    context->interpreter.setBool(slot, value != 0);
+    return SG_OK;
+}
+
+int sg_get_string(const sg_context* context, int slot, const char** data, size_t* length) {
+    if (!checkSlot(slot)) return SG_ERROR;
+    const std::string& str = context->interpreter.getString(slot);
+    *data = str.data();
+    *length = str.size();
+    return SG_OK;
+}
+
+int sg_set_string(sg_context* context, int slot, const char* data, size_t length) {
+    if (!checkSlot(slot)) return SG_ERROR;
+    context->interpreter.setString(slot, std::string(data, length));
+    return SG_OK;
+}
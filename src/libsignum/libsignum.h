@@ -0,0 +1,77 @@
+/* SigNum Embedding API (libsignum) */
+
+#ifndef LIBSIGNUM_H
+#define LIBSIGNUM_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 戻り値 */
+#define SG_OK 0
+#define SG_ERROR 1
+
+/* メモリプールのスロット（interpreter.hpp と同じ値） */
+#define SG_POOL_SIZE 64
+#define SG_ARGS_START 48
+#define SG_RETURN_START 56
+#define SG_SYSTEM_START 60
+
+/* コンパイル済みのプログラム（複数のコンテキストで共有でき、別スレッドから同時に sg_run してもよい。
+   実行中に書き換わるのは演算の特殊化の状態だけで、これはatomicに読み書きする） */
+typedef struct sg_program sg_program;
+/* 実行コンテキスト（メモリプール・スタック・関数・メモリマップを持つ） */
+typedef struct sg_context sg_context;
+
+/* 出力先のコールバック（出力はまとめて渡す。sg_run の終わりと出力を流す文 <; では必ず呼ばれる） */
+typedef void (*sg_output_fn)(void* user, const char* data, size_t length);
+/* ネイティブ関数（引数・戻り値はメモリプールの SG_ARGS_START〜・SG_RETURN_START〜 で受け渡す） */
+typedef void (*sg_native_fn)(sg_context* context, void* user);
+
+/* ネイティブ関数に予約した関数ID */
+#define SG_NATIVE_START 900
+#define SG_NATIVE_END 999
+
+/* 直前に失敗した呼び出しのエラーメッセージ（スレッドごと） */
+const char* sg_last_error(void);
+
+/* ソースを解析・検査・最適化してプログラムにする（失敗したらNULL） */
+sg_program* sg_compile(const char* source, size_t length);
+void sg_program_free(sg_program* program);
+
+/* コンテキストの作成・破棄 */
+sg_context* sg_context_new(void);
+void sg_context_free(sg_context* context);
+/* マシン状態を初期状態に戻す（出力先はそのまま） */
+void sg_context_reset(sg_context* context);
+/* 出力先を設定（NULLなら標準出力に戻す） */
+void sg_context_set_output(sg_context* context, sg_output_fn output, void* user);
+/* 入力文 > の入力元を設定（内容はコピーする。NULLなら標準入力に戻す）
+   入力は sg_run をまたいで続きから読み、設定し直すと先頭から読む */
+void sg_set_input(sg_context* context, const char* data, size_t length);
+
+/* ネイティブ関数を $_NNN に登録（全コンテキスト共通。NULLなら登録を外す）
+   呼び出すプログラムをコンパイルする前に登録する */
+int sg_register_native(int id, sg_native_fn function, void* user);
+
+/* プログラムを実行（状態はコンテキストに残る。実行時エラーならSG_ERROR） */
+int sg_run(sg_context* context, const sg_program* program);
+
+/* メモリプールを直接読み書きする（SG_POOL_SIZE個の配列） */
+int* sg_int_pool(sg_context* context);
+double* sg_float_pool(sg_context* context);
+
+/* 真偽値・文字列のスロット（範囲外ならSG_ERROR） */
+int sg_get_bool(const sg_context* context, int slot, int* value);
+int sg_set_bool(sg_context* context, int slot, int value);
+/* 文字列はコンテキスト内のものを指す（次にそのスロットが変わるまで有効） */
+int sg_get_string(const sg_context* context, int slot, const char** data, size_t* length);
+int sg_set_string(sg_context* context, int slot, const char* data, size_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LIBSIGNUM_H */
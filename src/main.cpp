@@ -1,15 +1,58 @@
 #include <iostream>
 #include <string>
 #include <fstream>
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <thread>
 #include "lexer/lexer.hpp"
 #include "parser/parser.hpp"
 #include "semantic/semantic.hpp"
 #include "interpreter/interpreter.hpp"
+#include "vm/compiler.hpp"
+#include "vm/vm.hpp"
+#include "closure/closure.hpp"
+#include "optimizer/optimizer.hpp"
+#include "transpiler/transpiler.hpp"
+#include "builder/builder.hpp"
+#include "serializer/serializer.hpp"
+#include "server/server.hpp"
+#include "batch/batch.hpp"
+#include "reader/reader.hpp"
+#include "snapshot/snapshot.hpp"
 #include "repl.hpp"
 #include "version.hpp"
 
-struct DebugConfig {
+// 実行エンジン
+enum class Engine {
+    Tree,   // ツリーウォーカー（リファレンス）
+    VM,     // バイトコードVM
+    Closure // クロージャコンパイル
+};
+
+// -n で行と行番号を入れるスロット（$@0・$#0）
+constexpr int STREAM_LINE_SLOT = 0;
+
+struct Config {
     bool debugMode = false;
+    Engine engine = Engine::Tree;
+    bool jit = true;
+    bool optimize = false;
+    bool emitCpp = false;
+    bool build = false;
+    bool compile = false;
+    std::string outputFile; // 出力先（空なら標準出力）
+    std::string serveSocket;  // 常駐サーバーのソケット
+    std::string clientSocket; // クライアントモードの接続先
+    bool sendSource = false;  // クライアントがソースの内容を送る
+    std::string snapshotIn;   // 実行前に復元する状態
+    std::string snapshotOut;  // 実行後に保存する状態
+    std::shared_ptr<const Interpreter> restored; // 復元した状態（意味解析で参照する）
+    bool streamMode = false;   // 入力の1行ごとにプログラムを実行する（-n）
+    bool noPrompt = false;     // 端末からの入力でも入力を促さずにまとめて読む
+    size_t mapWindow = MEMORY_MAP_SIZE; // メモリマップのウィンドウの要素数
+    std::string batchManifest; // 並列に実行するジョブの一覧
+    unsigned jobs = 0;         // ワーカー数（0ならCPU数）
 };
 
 void showhelp() {
@@ -18,10 +61,182 @@ void showhelp() {
     std::cout << "  -h, --help    Show this help message" << std::endl;
     std::cout << "  -v, --version Show version information" << std::endl;
     std::cout << "  -d, --debug   Enable debug mode" << std::endl;
+    std::cout << "  --engine=ENGINE  Select execution engine (tree, vm, closure)" << std::endl;
+    std::cout << "  --no-jit      Disable the native loop JIT" << std::endl;
+    std::cout << "  -O, -O1       Enable constant folding before execution (-O0 to disable)" << std::endl;
+    std::cout << "  --emit-cpp    Translate the program to C++ instead of running it" << std::endl;
+    std::cout << "  --compile     Write the checked program to a precompiled .sgnc file" << std::endl;
+    std::cout << "  --build       Build a native executable with the system C++ compiler (cached)" << std::endl;
+    std::cout << "  -o FILE       Write generated output to FILE" << std::endl;
+    std::cout << "  --snapshot-in FILE   Restore the machine state from FILE before running" << std::endl;
+    std::cout << "  --snapshot-out FILE  Save the machine state to FILE after running" << std::endl;
+    std::cout << "  -n            Run the program once per input line ($@0 = line, $#0 = line number)" << std::endl;
+    std::cout << "  --no-prompt   Read input without prompts even from a terminal (default when stdin is not a TTY)" << std::endl;
+    std::cout << "  --map-window N  Number of elements in a memory map window (default: 1024)" << std::endl;
+    std::cout << "  --batch FILE  Run the scripts listed in FILE in parallel (-o DIR for per-job output files)" << std::endl;
+    std::cout << "  -j N          Number of batch workers (default: number of CPUs)" << std::endl;
+    std::cout << "  --serve SOCK  Run as a resident server on a Unix domain socket" << std::endl;
+    std::cout << "  --client SOCK Run the file on a server (add --send-source to send its contents)" << std::endl;
+}
+
+// ソースを字句・構文・意味解析する（失敗したらエラーをerrorsに表示してnullptr）
+static std::shared_ptr<ASTNode> analyzeSource(const std::string& code, const Config& config,
+                                              std::ostream& errors = std::cerr) {
+    Lexer lexer(code);
+    auto tokens = lexer.tokenize();
+    if (lexer.hasErrors()) {
+        errors << "Lexical Analysis Failed!" << std::endl;
+        lexer.printErrors(errors);
+        return nullptr;
+    }
+    if (config.debugMode) {
+        std::cout << "=== Tokens ===" << std::endl;
+        printTokens(tokens);
+    }
+    Parser parser(tokens);
+    auto ast = parser.parseProgram();
+    if (!ast) {
+        errors << "Parsing Failed!" << std::endl;
+        if (parser.hasErrors()) {
+            parser.printErrors(errors);
+        }
+        return nullptr;
+    }
+    if (config.debugMode) {
+        std::cout << "\n=== AST ===" << std::endl;
+        ast->print();
+        std::cout << "\n=== JSON Output ===" << std::endl;
+        if (ast->saveToJSONFile("ast_output.json")) {
+            std::cout << "Save : ast_output.json" << std::endl << std::endl;
+        }
+    }
+    SemanticAnalyzer semanticAnalyzer;
+    semanticAnalyzer.setVerbose(false);
+    semanticAnalyzer.setMapWindowSize(config.mapWindow);
+    if (config.restored) {
+        // スナップショットの関数とスタックは実行開始時から使える
+        for (const auto& function : config.restored->definedFunctions()) {
+            semanticAnalyzer.declareFunction(function->value);
+        }
+        semanticAnalyzer.presetStackSizes(config.restored->stackSize('#'), config.restored->stackSize('~'),
+                                          config.restored->stackSize('@'), config.restored->stackSize('%'));
+    }
+    if (!semanticAnalyzer.analyze(ast)) {
+        for (const std::string& error : semanticAnalyzer.getErrors()) {
+            errors << "Semantic error: " << error << std::endl;
+        }
+        errors << "Semantic analysis failed!" << std::endl;
+        return nullptr;
+    }
+    return ast;
+}
+
+// 最適化パス（-O のときだけ）
+static std::shared_ptr<ASTNode> optimizeProgram(std::shared_ptr<ASTNode> ast, const Config& config) {
+    if (config.optimize) {
+        Optimizer optimizer;
+        ast = optimizer.optimize(ast);
+        if (config.debugMode) {
+            std::cout << "=== Optimized AST ===" << std::endl;
+            ast->print();
+            std::cout << std::endl;
+        }
+    }
+    return ast;
+}
+
+// 選択したエンジンで実行して終了コードを返す
+static int runProgram(const std::shared_ptr<ASTNode>& ast, const Config& config, std::istream& in = std::cin,
+                      std::ostream& out = std::cout, std::ostream& err = std::cerr) {
+    try {
+        Interpreter interpreter;
+        interpreter.setJitEnabled(config.jit);
+        interpreter.setMapWindowSize(config.mapWindow);
+        interpreter.setInput(in);
+        interpreter.setOutput(out);
+        if (config.noPrompt) {
+            interpreter.setInputPrompt(false);
+        }
+        std::shared_ptr<ASTNode> program = ast;
+        if (!config.snapshotIn.empty()) {
+            StateSnapshot::load(interpreter, config.snapshotIn);
+            // VM・クロージャは関数を自前の表に持つので、復元した定義を先頭で実行し直す
+            if (config.engine != Engine::Tree) {
+                program = std::make_shared<ASTNode>(NodeType::Program);
+                program->children = interpreter.definedFunctions();
+                program->children.insert(program->children.end(), ast->children.begin(), ast->children.end());
+            }
+        }
+        // -n では関数定義を先頭に集め、最初の行で1度だけ定義する（2行目からは定義以外の文だけを実行する）
+        std::shared_ptr<ASTNode> statements = program;
+        if (config.streamMode) {
+            std::shared_ptr<ASTNode> definitions = std::make_shared<ASTNode>(NodeType::Program);
+            statements = std::make_shared<ASTNode>(NodeType::Program);
+            for (const std::shared_ptr<ASTNode>& child : program->children) {
+                (child->type == NodeType::Function ? definitions : statements)->children.push_back(child);
+            }
+            program = definitions;
+            program->children.insert(program->children.end(), statements->children.begin(), statements->children.end());
+        }
+
+        // プログラムは1度だけコンパイルする
+        Bytecode bytecode;
+        VirtualMachine vm(interpreter);
+        ClosureCompiler closureCompiler(interpreter);
+        Action execute;
+        Action repeat;
+        if (config.engine == Engine::VM) {
+            BytecodeCompiler compiler;
+            bytecode = compiler.compile(program);
+            if (config.debugMode) {
+                std::cout << "=== Bytecode ===" << std::endl;
+                bytecode.print();
+                std::cout << std::endl;
+            }
+            execute = [&]() { vm.run(bytecode); };
+            // 関数定義は1つ1命令なので、本体は定義の数だけ進んだ位置から始まる
+            size_t entry = program->children.size() - statements->children.size();
+            repeat = [&, entry]() { vm.resume(bytecode, entry); };
+        }
+        else if (config.engine == Engine::Closure) {
+            execute = closureCompiler.compile(program);
+            if (config.streamMode) {
+                repeat = closureCompiler.compileNext(statements);
+            }
+        }
+        else {
+            execute = [&]() { interpreter.interpret(program); };
+            repeat = [&]() { interpreter.interpret(statements); };
+        }
+
+        if (config.streamMode) {
+            // 入力の1行ごとに、行を$@0・行番号を$#0に入れて本体を実行する（プールは持ち越す）
+            // 本体の入力文も同じバッファから続きを読む
+            InputReader& reader = interpreter.getInputReader();
+            std::string line;
+            for (int number = 1; reader.readLine(line); ++number) {
+                interpreter.setString(STREAM_LINE_SLOT, std::move(line));
+                interpreter.setInt(STREAM_LINE_SLOT, number);
+                (number == 1 ? execute : repeat)();
+            }
+        }
+        else {
+            execute();
+        }
+        if (!config.snapshotOut.empty()) {
+            StateSnapshot::save(interpreter, config.snapshotOut);
+        }
+    }
+    catch (const std::exception& e) {
+        out.flush();
+        err << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
 }
 
 int main(int argc, char* argv[]) {
-    DebugConfig config;
+    Config config;
     std::string filename;
     // 引数がない場合はREPLを起動
     if (argc == 1) {
@@ -30,33 +245,197 @@ int main(int argc, char* argv[]) {
         return 0;
     }
 
-    std::string arg = argv[1];
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
 
-    // ヘルプメッセージを表示
-    if (arg == "-h" || arg == "--help") {
-        showhelp();
-        return 0;
+        // ヘルプメッセージを表示
+        if (arg == "-h" || arg == "--help") {
+            showhelp();
+            return 0;
+        }
+        // バージョン情報を表示
+        else if (arg == "-v" || arg == "--version") {
+            std::cout << SigNum::getVersionString() << std::endl;
+            return 0;
+        }
+        // デバッグモードを有効にする
+        else if (arg == "-d" || arg == "--debug") {
+            config.debugMode = true;
+            std::cout << "Debug mode enabled." << std::endl;
+        }
+        // 実行エンジンの選択
+        else if (arg.rfind("--engine=", 0) == 0) {
+            std::string engine = arg.substr(9);
+            if (engine == "tree") {
+                config.engine = Engine::Tree;
+            }
+            else if (engine == "vm") {
+                config.engine = Engine::VM;
+            }
+            else if (engine == "closure") {
+                config.engine = Engine::Closure;
+            }
+            else {
+                std::cerr << "Error: Unknown engine: " << engine << std::endl;
+                return 1;
+            }
+        }
+        // 最適化パスの有効・無効
+        else if (arg == "-O" || arg == "-O1") {
+            config.optimize = true;
+        }
+        else if (arg == "-O0") {
+            config.optimize = false;
+        }
+        // ループのJITを無効にする
+        else if (arg == "--no-jit") {
+            config.jit = false;
+        }
+        // C++への変換
+        else if (arg == "--emit-cpp") {
+            config.emitCpp = true;
+        }
+        // コンパイル済みプログラムの書き出し
+        else if (arg == "--compile") {
+            config.compile = true;
+        }
+        // 実行ファイルのビルド
+        else if (arg == "--build") {
+            config.build = true;
+        }
+        // 出力先
+        else if (arg == "-o") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: -o requires a file name" << std::endl;
+                return 1;
+            }
+            config.outputFile = argv[++i];
+        }
+        // 常駐サーバー・クライアント
+        else if (arg == "--serve" || arg == "--client") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: " << arg << " requires a socket path" << std::endl;
+                return 1;
+            }
+            (arg == "--serve" ? config.serveSocket : config.clientSocket) = argv[++i];
+        }
+        // 状態のスナップショット
+        else if (arg == "--snapshot-in" || arg == "--snapshot-out") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: " << arg << " requires a file path" << std::endl;
+                return 1;
+            }
+            (arg == "--snapshot-in" ? config.snapshotIn : config.snapshotOut) = argv[++i];
+        }
+        // 行ごとの実行
+        else if (arg == "-n") {
+            config.streamMode = true;
+        }
+        // 入力を促さない
+        else if (arg == "--no-prompt") {
+            config.noPrompt = true;
+        }
+        // メモリマップのウィンドウの大きさ
+        else if (arg == "--map-window") {
+            char* end = nullptr;
+            long long size = i + 1 < argc ? std::strtoll(argv[i + 1], &end, 10) : 0;
+            if (i + 1 >= argc || *end != '\0' || size <= 0 || size > std::numeric_limits<int>::max()) {
+                std::cerr << "Error: --map-window requires a positive number of elements" << std::endl;
+                return 1;
+            }
+            config.mapWindow = static_cast<size_t>(size);
+            ++i;
+        }
+        // 並列バッチ実行
+        else if (arg == "--batch") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --batch requires a manifest file" << std::endl;
+                return 1;
+            }
+            config.batchManifest = argv[++i];
+        }
+        else if (arg == "-j") {
+            if (i + 1 >= argc || std::atoi(argv[i + 1]) <= 0) {
+                std::cerr << "Error: -j requires a positive number of workers" << std::endl;
+                return 1;
+            }
+            config.jobs = static_cast<unsigned>(std::atoi(argv[++i]));
+        }
+        else if (arg == "--send-source") {
+            config.sendSource = true;
+        }
+        else if (!arg.empty() && arg[0] == '-') {
+            std::cerr << "Error: Unknown option: " << arg << std::endl;
+            showhelp();
+            return 1;
+        }
+        else {
+            // ファイル名を取得
+            filename = arg;
+        }
     }
-    // バージョン情報を表示
-    else if (arg == "-v" || arg == "--version") {
-        std::cout << SigNum::getVersionString() << std::endl;
-        return 0;
+
+    if (!config.snapshotIn.empty()) {
+        // 意味解析用に一度読んでおく（実行時は毎回ファイルから復元する）
+        try {
+            auto restored = std::make_shared<Interpreter>();
+            restored->setMapWindowSize(config.mapWindow);
+            StateSnapshot::load(*restored, config.snapshotIn);
+            config.restored = restored;
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
     }
-    // デバッグモードを有効にする
-    else if (arg == "-d" || arg == "--debug") {
-        config.debugMode = true;
-        std::cout << "Debug mode enabled." << std::endl;
-        if (argc > 2) {
-            filename = argv[2];
+
+    if (!config.batchManifest.empty()) {
+        // ジョブが同時に同じファイルへ書き込むことになる
+        if (!config.snapshotOut.empty()) {
+            std::cerr << "Error: --snapshot-out cannot be used with --batch" << std::endl;
+            return 1;
         }
-        else {
-            std::cerr << "Error: No file specified for debug mode." << std::endl;
+        // ワーカーごとに新しいInterpreterで実行し、解析済みのASTは同じソースのジョブで共有する
+        BatchRunner batch(
+            [&config](const std::string& code, std::ostream& errors) {
+                auto ast = analyzeSource(code, config, errors);
+                return ast ? optimizeProgram(ast, config) : ast;
+            },
+            [&config](const std::shared_ptr<ASTNode>& program, std::istream& in, std::ostream& out, std::ostream& err) {
+                return runProgram(program, config, in, out, err);
+            });
+        try {
+            unsigned threads = config.jobs ? config.jobs : std::max(1u, std::thread::hardware_concurrency());
+            return batch.run(config.batchManifest, threads, config.outputFile);
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
             return 1;
         }
     }
-    else {
-        // ファイル名を取得
-        filename = arg;
+
+    if (!config.serveSocket.empty()) {
+        // 解析済みのプログラムはサーバーがキャッシュし、実行は要求ごとに新しいInterpreterで行う
+        ScriptServer server(
+            config.serveSocket,
+            [&config](const std::string& code) {
+                auto ast = analyzeSource(code, config);
+                return ast ? optimizeProgram(ast, config) : ast;
+            },
+            [&config](const std::shared_ptr<ASTNode>& program) { return runProgram(program, config); });
+        try {
+            server.serve();
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    if (config.debugMode && filename.empty()) {
+        std::cerr << "Error: No file specified for debug mode." << std::endl;
+        return 1;
     }
 
     if (filename.empty()) {
@@ -65,10 +444,25 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
+    if (!config.clientSocket.empty()) {
+        try {
+            return runScriptClient(config.clientSocket, filename, config.sendSource);
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
     size_t dotPos = filename.find_last_of('.');
-    if (dotPos == std::string::npos || 
-        (filename.substr(dotPos) != ".sgnm" && filename.substr(dotPos) != ".sg")) {
-        std::cerr << "Error: Invalid file extension. Expected .sgnm or .sg file" << std::endl;
+    std::string extension = dotPos == std::string::npos ? "" : filename.substr(dotPos);
+    if (extension != ".sgnm" && extension != ".sg" && extension != ".sgnc") {
+        std::cerr << "Error: Invalid file extension. Expected .sgnm, .sg or .sgnc file" << std::endl;
+        return 1;
+    }
+    bool precompiled = extension == ".sgnc";
+    if (precompiled && config.compile) {
+        std::cerr << "Error: " << filename << " is already compiled" << std::endl;
         return 1;
     }
 
@@ -80,48 +474,70 @@ int main(int argc, char* argv[]) {
     }
 
     try {
-        std::string code((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-
-        Lexer lexer(code);
-        auto tokens = lexer.tokenize();
-        if (lexer.hasErrors()) {
-            std::cerr << "Lexical Analysis Failed!" << std::endl;
-            lexer.printErrors();
-            return 1;
+        std::shared_ptr<ASTNode> ast;
+        std::string code;
+        if (precompiled) {
+            // コンパイル済みのプログラムは字句・構文・意味解析を省略する
+            file.close();
+            ast = ProgramSerializer::load(filename);
+            if (config.debugMode) {
+                std::cout << "=== AST (precompiled) ===" << std::endl;
+                ast->print();
+                std::cout << std::endl;
+            }
         }
-        if (config.debugMode) {
-            std::cout << "=== Tokens ===" << std::endl;
-            printTokens(tokens);
+        else {
+            code.assign((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            ast = analyzeSource(code, config);
+            if (!ast) {
+                return 1;
+            }
         }
-        Parser parser(tokens);
-        auto ast = parser.parseProgram();
 
-        if (ast) {
-            if (config.debugMode) {
-                std::cout << "\n=== AST ===" << std::endl;
-                ast->print();
-                std::cout << "\n=== JSON Output ===" << std::endl;
-                if (ast->saveToJSONFile("ast_output.json")) {
-                    std::cout << "Save : ast_output.json" << std::endl << std::endl;
+        ast = optimizeProgram(ast, config);
+        if (config.compile) {
+            std::string output = config.outputFile;
+            if (output.empty()) {
+                output = filename.substr(0, dotPos) + ".sgnc";
+            }
+            size_t slash = filename.find_last_of("/\\");
+            std::string sourceName = slash == std::string::npos ? filename : filename.substr(slash + 1);
+            ProgramSerializer::save(ast, output, code, sourceName);
+            return 0;
+        }
+        if (config.emitCpp) {
+            CppTranspiler transpiler;
+            if (config.mapWindow != MEMORY_MAP_SIZE) {
+                transpiler.setMapWindowSize(config.mapWindow);
+            }
+            std::string source = transpiler.transpile(ast);
+            if (config.outputFile.empty()) {
+                std::cout << source;
+            } else {
+                std::ofstream output(config.outputFile);
+                if (!output) {
+                    std::cerr << "Error: Could not open file " << config.outputFile << std::endl;
+                    return 1;
                 }
+                output << source;
             }
-            SemanticAnalyzer semanticAnalyzer;
-            if (semanticAnalyzer.analyze(ast)) {
-                Interpreter interpreter;
-                interpreter.interpret(ast);
-            } 
-            else {
-                std::cerr << "Semantic analysis failed!" << std::endl;
-                return 1;
+            return 0;
+        }
+        if (config.build) {
+            std::string output = config.outputFile;
+            if (output.empty()) {
+                output = filename.substr(0, dotPos);
             }
-        } 
-        else {
-            std::cerr << "Parsing Failed!" << std::endl;
-            if (parser.hasErrors()) {
-                parser.printErrors();
+            NativeBuilder builder;
+            builder.setVerbose(config.debugMode);
+            if (config.mapWindow != MEMORY_MAP_SIZE) {
+                builder.setMapWindowSize(config.mapWindow);
             }
-            return 1;
+            builder.build(ast, output);
+            return 0;
         }
+
+        return runProgram(ast, config);
     } 
     catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
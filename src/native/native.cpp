@@ -0,0 +1,31 @@
+// SigNum Native Function Registry
+
+#include <stdexcept>
+#include <string>
+#include "native.hpp"
+
+NativeRegistry::Table& NativeRegistry::table() {
+    // 最初に使われたときに標準ライブラリを入れる
+    static Table functions = [] {
+        Table initial;
+        addStandardLibrary(initial);
+        return initial;
+    }();
+    return functions;
+}
+
+// 登録
+void NativeRegistry::add(int id, NativeFunction function) {
+    if (id < NATIVE_FUNCTION_START || id > NATIVE_FUNCTION_END) {
+        throw std::out_of_range("Native function ID must be in range " + std::to_string(NATIVE_FUNCTION_START) +
+                                "-" + std::to_string(NATIVE_FUNCTION_END) + ": " + std::to_string(id));
+    }
+    table()[id - NATIVE_FUNCTION_START] = std::move(function);
+}
+
+// 登録を外す
+void NativeRegistry::remove(int id) {
+    if (id >= NATIVE_FUNCTION_START && id <= NATIVE_FUNCTION_END) {
+        table()[id - NATIVE_FUNCTION_START] = nullptr;
+    }
+}
@@ -0,0 +1,61 @@
+// SigNum Native Function Registry
+
+#pragma once
+
+#include <array>
+#include <functional>
+
+class Interpreter;
+
+// ネイティブ関数に予約した関数IDの範囲（$_900〜$_999）
+constexpr int NATIVE_FUNCTION_START = 900;
+constexpr int NATIVE_FUNCTION_END = 999;
+
+// 標準ライブラリに使う関数ID（$_900〜$_943）
+// 十の位が対象、一の位が操作
+//   対象: 90x=intスタック 91x=floatスタック 92x=^#のウィンドウ 93x=^~のウィンドウ
+//   操作: 0=ソート 1=反転 2=二分探索 3=重複除去 4=最小 5=最大 6=合計
+// 引数: $#48=ウィンドウ内の先頭 $#49=要素数（メモリマップのみ） $#50・$~50=探索するキー
+// 戻り値: 最小・最大・合計は$#56・$~56、探索の位置（なければ-1）と重複除去後の要素数は$#56
+//
+// 94x はメモリマップの大きさを調べる（一の位が対象: 0=^# 1=^~ 2=^@ 3=^%）
+// 戻り値: ファイル全体の要素数を$~56（intに収まらなければ$#56は上限値）、ウィンドウの位置を$~57・$#57
+constexpr int NATIVE_STDLIB_START = 900;
+constexpr int NATIVE_STDLIB_END = 943;
+constexpr int NATIVE_STDLIB_MAP_INFO = 940;
+
+// 標準ライブラリの関数IDか
+constexpr bool isStandardFunction(int id) {
+    return id >= NATIVE_STDLIB_MAP_INFO ? id <= NATIVE_STDLIB_END : id >= NATIVE_STDLIB_START && id % 10 <= 6;
+}
+
+// ネイティブ関数
+// 引数はメモリプールの ARGS_START〜、戻り値は RETURN_START〜 を直接読み書きする
+using NativeFunction = std::function<void(Interpreter& interpreter)>;
+
+// 関数IDに結び付けたホストのC++関数の表（全エンジン・意味解析で共有）
+// 登録は実行を始める前に済ませる
+class NativeRegistry {
+public:
+    using Table = std::array<NativeFunction, NATIVE_FUNCTION_END - NATIVE_FUNCTION_START + 1>;
+
+private:
+    static Table& table();
+    // 標準ライブラリを登録（stdlib.cpp）
+    static void addStandardLibrary(Table& functions);
+
+public:
+    // 登録（予約範囲外なら例外。同じIDは上書き）
+    static void add(int id, NativeFunction function);
+    // 登録を外す
+    static void remove(int id);
+
+    // 登録済みの関数（なければnullptr）
+    static const NativeFunction* find(int id) {
+        if (id < NATIVE_FUNCTION_START || id > NATIVE_FUNCTION_END) {
+            return nullptr;
+        }
+        const NativeFunction& function = table()[id - NATIVE_FUNCTION_START];
+        return function ? &function : nullptr;
+    }
+};
@@ -0,0 +1,171 @@
+// SigNum Native Standard Library
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "native.hpp"
+#include "../interpreter/interpreter.hpp"
+
+namespace {
+
+// 操作（関数IDの一の位）
+enum class Operation {
+    Sort = 0,
+    Reverse = 1,
+    Search = 2,
+    Dedupe = 3,
+    Min = 4,
+    Max = 5,
+    Sum = 6
+};
+
+// 全順序の比較（NaNは最後に並べる）
+template <typename T>
+bool less(T a, T b) {
+    if constexpr (std::is_floating_point_v<T>) {
+        return a < b || (!std::isnan(a) && std::isnan(b));
+    } else {
+        return a < b;
+    }
+}
+
+// less で前後の決まらない値は等しい（重複除去ではNaN同士も1つにまとめる）
+template <typename T>
+bool equal(T a, T b) {
+    return !less(a, b) && !less(b, a);
+}
+
+// 結果の書き込み（型に合わせて$#56か$~56。$#56はintの範囲で頭打ち）
+void setResult(Interpreter& interpreter, long long value) {
+    long long clamped = std::clamp<long long>(value, std::numeric_limits<int>::min(), std::numeric_limits<int>::max());
+    interpreter.setInt(RETURN_START, static_cast<int>(clamped));
+}
+void setResult(Interpreter& interpreter, double value) { interpreter.setFloat(RETURN_START, value); }
+
+// 探索するキー（$#50か$~50）
+template <typename T>
+T searchKey(Interpreter& interpreter) {
+    if constexpr (std::is_floating_point_v<T>) {
+        return static_cast<T>(interpreter.getFloat(ARGS_START + 2));
+    } else {
+        return static_cast<T>(interpreter.getInt(ARGS_START + 2));
+    }
+}
+
+// 要素の列に操作を適用して、残す要素数を返す（並びを変えない操作はそのままの要素数）
+template <typename T>
+size_t apply(Operation operation, T* data, size_t count, Interpreter& interpreter) {
+    using Sum = std::conditional_t<std::is_floating_point_v<T>, double, long long>;
+    switch (operation) {
+        case Operation::Sort:
+            std::sort(data, data + count, less<T>);
+            return count;
+        case Operation::Reverse:
+            std::reverse(data, data + count);
+            return count;
+        case Operation::Search: {
+            T key = searchKey<T>(interpreter);
+            T* found = std::lower_bound(data, data + count, key, less<T>);
+            bool hit = found != data + count && !less(key, *found);
+            interpreter.setInt(RETURN_START, hit ? static_cast<int>(found - data) : -1);
+            return count;
+        }
+        case Operation::Dedupe: {
+            size_t unique = static_cast<size_t>(std::unique(data, data + count, equal<T>) - data);
+            interpreter.setInt(RETURN_START, static_cast<int>(unique));
+            return unique;
+        }
+        case Operation::Min:
+        case Operation::Max: {
+            if (count == 0) {
+                throw std::runtime_error(std::string(operation == Operation::Min ? "Min" : "Max") + " of an empty range");
+            }
+            T* result = operation == Operation::Min ? std::min_element(data, data + count, less<T>)
+                                                    : std::max_element(data, data + count, less<T>);
+            setResult(interpreter, static_cast<Sum>(*result));
+            return count;
+        }
+        case Operation::Sum: {
+            Sum total = 0;
+            for (size_t i = 0; i < count; ++i) {
+                total += data[i];
+            }
+            setResult(interpreter, total);
+            if constexpr (!std::is_floating_point_v<T>) {
+                // intに収まらない合計もそのままの値を$~56で返す
+                interpreter.setFloat(RETURN_START, static_cast<double>(total));
+            }
+            return count;
+        }
+    }
+    return count;
+}
+
+// スタック全体に適用（重複除去ではスタックを縮める）
+template <typename T>
+void applyToStack(Operation operation, std::vector<T>& stack, Interpreter& interpreter) {
+    stack.resize(apply(operation, stack.data(), stack.size(), interpreter));
+}
+
+// メモリマップのウィンドウの範囲に適用（1回の読み込みと書き込みで済ませる）
+template <typename Stored>
+void applyToMap(Operation operation, char type, Interpreter& interpreter) {
+    MemoryMap& map = interpreter.getMemoryMap(type);
+    if (!map.isMapped()) {
+        throw std::runtime_error("Memory map not initialized for type: " + std::string(1, type));
+    }
+    int start = interpreter.getInt(ARGS_START);
+    int count = interpreter.getInt(ARGS_START + 1);
+    if (start < 0 || count < 0 || static_cast<size_t>(start) + static_cast<size_t>(count) > map.getWindowSize()) {
+        throw std::out_of_range("Memory map range out of range: " + std::to_string(start) + "+" +
+                                std::to_string(count));
+    }
+    std::vector<Stored> data(static_cast<size_t>(count));
+    map.readBlock(start, data.size(), data.data());
+    size_t kept = apply(operation, data.data(), data.size(), interpreter);
+    if (operation == Operation::Sort || operation == Operation::Reverse || operation == Operation::Dedupe) {
+        map.writeBlock(start, kept, data.data());
+    }
+}
+
+// メモリマップのファイル全体の要素数とウィンドウの位置を返す（$#はintの上限で頭打ち）
+void mapInfo(char type, Interpreter& interpreter) {
+    MemoryMap& map = interpreter.getMemoryMap(type);
+    if (!map.isMapped()) {
+        throw std::runtime_error("Memory map not initialized for type: " + std::string(1, type));
+    }
+    auto setSize = [&interpreter](int slot, size_t value) {
+        interpreter.setInt(slot, static_cast<int>(std::min<size_t>(value, std::numeric_limits<int>::max())));
+        interpreter.setFloat(slot, static_cast<double>(value));
+    };
+    setSize(RETURN_START, map.elementCount());
+    setSize(RETURN_START + 1, map.getWindowOffset());
+}
+
+} // namespace
+
+// 標準ライブラリを登録
+void NativeRegistry::addStandardLibrary(Table& functions) {
+    for (int op = 0; op <= static_cast<int>(Operation::Sum); ++op) {
+        Operation operation = static_cast<Operation>(op);
+        auto at = [&functions](int id) -> NativeFunction& { return functions[id - NATIVE_FUNCTION_START]; };
+        at(900 + op) = [operation](Interpreter& interpreter) {
+            applyToStack(operation, interpreter.getIntStack(), interpreter);
+        };
+        at(910 + op) = [operation](Interpreter& interpreter) {
+            applyToStack(operation, interpreter.getFloatStack(), interpreter);
+        };
+        at(920 + op) = [operation](Interpreter& interpreter) { applyToMap<int32_t>(operation, '#', interpreter); };
+        at(930 + op) = [operation](Interpreter& interpreter) { applyToMap<float>(operation, '~', interpreter); };
+    }
+    const char mapTypes[] = {'#', '~', '@', '%'};
+    for (int i = 0; i < 4; ++i) {
+        char type = mapTypes[i];
+        functions[NATIVE_STDLIB_MAP_INFO + i - NATIVE_FUNCTION_START] = [type](Interpreter& interpreter) {
+            mapInfo(type, interpreter);
+        };
+    }
+}
@@ -0,0 +1,208 @@
+// SigNum Optimizer
+
+#include "optimizer.hpp"
+#include "../interpreter/interpreter.hpp"
+
+// プログラム全体を最適化
+std::shared_ptr<ASTNode> Optimizer::optimize(const std::shared_ptr<ASTNode>& program) {
+    return optimizeNode(program);
+}
+
+// 定数ノードの作成
+std::shared_ptr<ASTNode> Optimizer::makeConstant(const Value& value) {
+    auto node = std::make_shared<ASTNode>(NodeType::Constant, Interpreter::valueToString(value));
+    node->constant = std::make_shared<const Value>(value);
+    return node;
+}
+
+// 定数ノードの値
+const Value* Optimizer::constantOf(const std::shared_ptr<ASTNode>& node) {
+    return node->constant.get();
+}
+
+// 静的にintと分かる式か
+bool Optimizer::isIntExpression(const std::shared_ptr<ASTNode>& node) {
+    if (node->constant) {
+        return std::holds_alternative<int>(*node->constant);
+    }
+    switch (node->type) {
+        case NodeType::MemoryRef:
+            return node->memory.valid && !node->memory.isMap && node->memory.type == '#';
+        case NodeType::ArithmeticExpression:
+            if (node->children.size() == 1) {
+                return isIntExpression(node->children[0]);
+            }
+            return node->children.size() == 2 &&
+                   isIntExpression(node->children[0]) && isIntExpression(node->children[1]);
+        case NodeType::StringLength:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// 副作用も例外もないint式か
+bool Optimizer::isPureIntExpression(const std::shared_ptr<ASTNode>& node) {
+    if (node->constant) {
+        return std::holds_alternative<int>(*node->constant);
+    }
+    switch (node->type) {
+        case NodeType::MemoryRef: {
+            // 添字が静的な単純参照のみ（ネストした参照は範囲外になりうる）
+            const MemoryDescriptor& mem = node->memory;
+            return mem.valid && !mem.isMap && mem.type == '#' && mem.indirection.empty() &&
+                   mem.index >= 0 && mem.index < static_cast<int>(MEMORY_POOL_SIZE);
+        }
+        case NodeType::ArithmeticExpression:
+            if (node->children.size() == 1) {
+                return isPureIntExpression(node->children[0]);
+            }
+            // 除算・剰余はゼロ除算がありうる
+            return node->children.size() == 2 &&
+                   node->op != Operator::Divide && node->op != Operator::Modulus &&
+                   isPureIntExpression(node->children[0]) && isPureIntExpression(node->children[1]);
+        default:
+            return false;
+    }
+}
+
+// ノードを最適化
+std::shared_ptr<ASTNode> Optimizer::optimizeNode(const std::shared_ptr<ASTNode>& node) {
+    if (!node) {
+        return node;
+    }
+
+    for (auto& child : node->children) {
+        child = optimizeNode(child);
+    }
+
+    if (auto folded = foldExpression(node)) {
+        return folded;
+    }
+    if (node->type == NodeType::ArithmeticExpression) {
+        if (auto simplified = simplifyArithmetic(node)) {
+            return simplified;
+        }
+    }
+    return node;
+}
+
+// 定数だけの式を畳み込む
+std::shared_ptr<ASTNode> Optimizer::foldExpression(const std::shared_ptr<ASTNode>& node) {
+    const auto& children = node->children;
+    if (children.empty()) {
+        return nullptr;
+    }
+    for (const auto& child : children) {
+        if (!constantOf(child)) {
+            return nullptr;
+        }
+    }
+    const Value& first = *constantOf(children[0]);
+
+    // 実行時にエラーになる式はそのまま残す
+    try {
+        switch (node->type) {
+            case NodeType::ArithmeticExpression:
+                if (children.size() == 1) return children[0];
+                if (children.size() == 2) {
+                    return makeConstant(Interpreter::applyArithmetic(node->op, first, *constantOf(children[1])));
+                }
+                break;
+
+            case NodeType::Comparison:
+                if (children.size() == 2) {
+                    return makeConstant(Interpreter::applyComparison(node->op, first, *constantOf(children[1])));
+                }
+                break;
+
+            case NodeType::LogicalExpression:
+                if (children.size() == 1) {
+                    if (node->op != Operator::Not) return children[0];
+                    if (std::holds_alternative<bool>(first)) {
+                        return makeConstant(!std::get<bool>(first));
+                    }
+                }
+                else if (children.size() == 2) {
+                    const Value& second = *constantOf(children[1]);
+                    if (std::holds_alternative<bool>(first) && std::holds_alternative<bool>(second)) {
+                        if (node->op == Operator::And) return makeConstant(std::get<bool>(first) && std::get<bool>(second));
+                        if (node->op == Operator::Or) return makeConstant(std::get<bool>(first) || std::get<bool>(second));
+                    }
+                }
+                break;
+
+            case NodeType::Cast:
+                return makeConstant(Interpreter::applyCast(node->op, first));
+
+            case NodeType::CharCodeCast:
+                return makeConstant(Interpreter::applyCharCodeCast(node->op, first));
+
+            case NodeType::StringLength:
+                if (std::holds_alternative<std::string>(first)) {
+                    return makeConstant(static_cast<int>(std::get<std::string>(first).length()));
+                }
+                break;
+
+            case NodeType::StringIndex:
+                if (children.size() == 2 && std::holds_alternative<std::string>(first) &&
+                    std::holds_alternative<int>(*constantOf(children[1]))) {
+                    const std::string& str = std::get<std::string>(first);
+                    int index = std::get<int>(*constantOf(children[1]));
+                    if (index >= 0 && index < static_cast<int>(str.length())) {
+                        return makeConstant(std::string(1, str[index]));
+                    }
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+    catch (const std::exception&) {
+        return nullptr;
+    }
+    return nullptr;
+}
+
+// intの恒等式を簡約する
+std::shared_ptr<ASTNode> Optimizer::simplifyArithmetic(const std::shared_ptr<ASTNode>& node) {
+    if (node->children.size() != 2) {
+        return nullptr;
+    }
+    const auto& left = node->children[0];
+    const auto& right = node->children[1];
+    if (!isIntExpression(left) || !isIntExpression(right)) {
+        return nullptr;
+    }
+
+    auto isInt = [](const std::shared_ptr<ASTNode>& operand, int value) {
+        const Value* constant = constantOf(operand);
+        return constant && std::holds_alternative<int>(*constant) && std::get<int>(*constant) == value;
+    };
+
+    switch (node->op) {
+        case Operator::Add:
+            if (isInt(right, 0)) return left;   // x + 0
+            if (isInt(left, 0)) return right;   // 0 + x
+            break;
+        case Operator::Subtract:
+            if (isInt(right, 0)) return left;   // x - 0
+            break;
+        case Operator::Multiply:
+            if (isInt(right, 1)) return left;   // x * 1
+            if (isInt(left, 1)) return right;   // 1 * x
+            // x * 0（xを評価しなくてよい場合のみ）
+            if ((isInt(right, 0) && isPureIntExpression(left)) ||
+                (isInt(left, 0) && isPureIntExpression(right))) {
+                return makeConstant(0);
+            }
+            break;
+        case Operator::Divide:
+            if (isInt(right, 1)) return left;   // x / 1
+            break;
+        default:
+            break;
+    }
+    return nullptr;
+}
@@ -0,0 +1,36 @@
+// SigNum Optimizer
+
+#pragma once
+
+#include <memory>
+#include "../ast/ast.hpp"
+
+// 実行前の最適化パス
+// - 定数だけの式を畳み込む
+// - intの恒等式を簡約する（x*1, x+0, x-0, x*0）
+class Optimizer {
+private:
+    // ノードを最適化して置き換え後のノードを返す
+    std::shared_ptr<ASTNode> optimizeNode(const std::shared_ptr<ASTNode>& node);
+
+    // 式の畳み込み（できなければnullptr）
+    std::shared_ptr<ASTNode> foldExpression(const std::shared_ptr<ASTNode>& node);
+    // intの恒等式の簡約（できなければnullptr）
+    std::shared_ptr<ASTNode> simplifyArithmetic(const std::shared_ptr<ASTNode>& node);
+
+    // 定数ノードの作成
+    static std::shared_ptr<ASTNode> makeConstant(const Value& value);
+    // 定数ノードの値（定数でなければnullptr）
+    static const Value* constantOf(const std::shared_ptr<ASTNode>& node);
+
+    // 静的にintと分かる式か
+    static bool isIntExpression(const std::shared_ptr<ASTNode>& node);
+    // 副作用も例外もないint式か
+    static bool isPureIntExpression(const std::shared_ptr<ASTNode>& node);
+
+public:
+    Optimizer() = default;
+
+    // プログラム全体を最適化
+    std::shared_ptr<ASTNode> optimize(const std::shared_ptr<ASTNode>& program);
+};
@@ -211,6 +211,7 @@ std::shared_ptr<ASTNode> Parser::parseStatement() {
 std::shared_ptr<ASTNode> Parser::parseMemoryRef() {
     if (tokens[pos].type == TokenType::MemoryRef) {
         auto node = std::make_shared<ASTNode>(NodeType::MemoryRef, tokens[pos].value);
+        node->memory = decodeMemoryRef(node->value);
         advance();
         
         // インデックスアクセスをチェック
@@ -245,6 +246,7 @@ std::shared_ptr<ASTNode> Parser::parseMemoryRef() {
 std::shared_ptr<ASTNode> Parser::parseMemoryMapRef() {
     if (tokens[pos].type == TokenType::MemoryMapRef) {
         auto node = std::make_shared<ASTNode>(NodeType::MemoryMapRef, tokens[pos].value);
+        node->memory = decodeMemoryRef(node->value);
         advance();
         return node;
     }
@@ -259,10 +261,12 @@ std::shared_ptr<ASTNode> Parser::parseExpression() {
 
     while (pos < tokens.size() && (tokens[pos].type == TokenType::Plus || tokens[pos].type == TokenType::Minus)) {
         auto op = tokens[pos].value;
+        Operator opType = tokenToOperator(tokens[pos].type);
         advance();
         
         auto right = parseTerm();
         auto node = std::make_shared<ASTNode>(NodeType::ArithmeticExpression, op);
+        node->op = opType;
         node->children.push_back(std::move(left));
         node->children.push_back(std::move(right));
         left = std::move(node);
@@ -278,10 +282,12 @@ std::shared_ptr<ASTNode> Parser::parseTerm() {
 
     while (pos < tokens.size() && (tokens[pos].type == TokenType::Multiply || tokens[pos].type == TokenType::Divide || tokens[pos].type == TokenType::Modulus)) {
         auto op = tokens[pos].value;
+        Operator opType = tokenToOperator(tokens[pos].type);
         advance(); // 演算子をスキップ
         
         auto right = parseFactor(); // 右辺の因子
         auto node = std::make_shared<ASTNode>(NodeType::ArithmeticExpression, op);
+        node->op = opType;
         node->children.push_back(std::move(left));
         node->children.push_back(std::move(right)); // 右辺の因子
         left = std::move(node); // 左辺を更新
@@ -303,11 +309,13 @@ std::shared_ptr<ASTNode> Parser::parseFactor() {
     if (tokens[pos].type == TokenType::Integer || tokens[pos].type == TokenType::Float) {
         debugLog("数値を解析中...");
         node = std::make_shared<ASTNode>(NodeType::Number, tokens[pos].value);
+        node->constant = constants.number(tokens[pos].value);
         advance();
     } 
     else if (tokens[pos].type == TokenType::String) {
         debugLog("文字列を解析中...");
         node = std::make_shared<ASTNode>(NodeType::String, tokens[pos].value);
+        node->constant = constants.string(tokens[pos].value);
         advance();
     } 
     else if (tokens[pos].type == TokenType::MemoryRef) {
@@ -372,19 +380,12 @@ std::shared_ptr<ASTNode> Parser::parseFactor() {
         tokens[pos].type == TokenType::BooleanStackPop
     )) {
         debugLog("スタック操作を解析中...");
-        std::string operation;
-        if (tokens[pos].type == TokenType::IntegerStackPush) operation = "IntegerStackPush";
-        else if (tokens[pos].type == TokenType::IntegerStackPop) operation = "IntegerStackPop";
-        else if (tokens[pos].type == TokenType::FloatStackPush) operation = "FloatStackPush";
-        else if (tokens[pos].type == TokenType::FloatStackPop) operation = "FloatStackPop";
-        else if (tokens[pos].type == TokenType::StringStackPush) operation = "StringStackPush";
-        else if (tokens[pos].type == TokenType::StringStackPop) operation = "StringStackPop";
-        else if (tokens[pos].type == TokenType::BooleanStackPush) operation = "BooleanStackPush";
-        else if (tokens[pos].type == TokenType::BooleanStackPop) operation = "BooleanStackPop";
+        Operator operation = tokenToOperator(tokens[pos].type);
 
         advance(); // スタック操作をスキップ
 
-        auto stackNode = std::make_shared<ASTNode>(NodeType::StackOperation, operation);
+        auto stackNode = std::make_shared<ASTNode>(NodeType::StackOperation, operator2String(operation));
+        stackNode->op = operation;
         stackNode->children.push_back(node);
         node = stackNode;
     }
@@ -423,6 +424,8 @@ std::shared_ptr<ASTNode> Parser::parseAssignment() {
     advance(); // 演算子をスキップ
     
     std::string leftValue = left->value;
+    NodeType leftType = (left->type == NodeType::MemoryMapRef) ? NodeType::MemoryMapRef : NodeType::MemoryRef;
+    MemoryDescriptor leftMemory = left->memory;
 
     auto node = std::make_shared<ASTNode>(NodeType::Assignment, opValue);
     node->children.push_back(std::move(left));
@@ -434,31 +437,21 @@ std::shared_ptr<ASTNode> Parser::parseAssignment() {
     // 複合代入（+=, -=, *=, /=, %=）
     else {
         // 左辺のコピーを作成
-        auto leftCopy = std::make_shared<ASTNode>(NodeType::MemoryRef, leftValue);
+        auto leftCopy = std::make_shared<ASTNode>(leftType, leftValue);
+        leftCopy->memory = leftMemory;
 
         // 演算子抽出
-        std::string actualOp;
-        if (opType == TokenType::PlusEqual) {
-            actualOp = "+";
-        }
-        else if (opType == TokenType::MinusEqual) {
-            actualOp = "-";
-        }
-        else if (opType == TokenType::MultiplyEqual) {
-            actualOp = "*";
-        }
-        else if (opType == TokenType::DivideEqual) {
-            actualOp = "/";
-        }
-        else if (opType == TokenType::ModulusEqual) {
-            actualOp = "%";
-        }
-        else {
+        Operator actualOp = tokenToOperator(opType);
+        if (actualOp < Operator::Add || actualOp > Operator::Modulus) {
             return recoverFromError("Error: Unknown compound assignment operator");
         }
 
+        // その場で更新できるよう代入ノードにも演算子を記録
+        node->op = actualOp;
+
         // 右辺の式を構築
-        auto right = std::make_shared<ASTNode>(NodeType::ArithmeticExpression, actualOp);
+        auto right = std::make_shared<ASTNode>(NodeType::ArithmeticExpression, operator2String(actualOp));
+        right->op = actualOp;
         right->children.push_back(std::move(leftCopy));
         right->children.push_back(parseExpression());
         
@@ -487,6 +480,7 @@ std::shared_ptr<ASTNode> Parser::parseComparison() {
         
         // 比較ノードを作成
         auto node = std::make_shared<ASTNode>(NodeType::Comparison, tokens[pos].value);
+        node->op = tokenToOperator(tokens[pos].type);
         node->children.push_back(std::move(left));
         
         advance(); //　比較演算子
@@ -506,6 +500,7 @@ std::shared_ptr<ASTNode> Parser::parseCondition() {
     // NOTの処理
     if (tokens[pos].type == TokenType::Not) {
         auto node = std::make_shared<ASTNode>(NodeType::LogicalExpression, "!");
+        node->op = Operator::Not;
         advance(); // "!" をスキップ
         node->children.push_back(parseCondition()); // NOTの後の式
         return node;
@@ -517,10 +512,12 @@ std::shared_ptr<ASTNode> Parser::parseCondition() {
     // AND/ORが続く場合
     while (pos < tokens.size() && (tokens[pos].type == TokenType::And || tokens[pos].type == TokenType::Or)) {
         auto op = tokens[pos].value; // "&&"  "||"
+        Operator opType = tokenToOperator(tokens[pos].type);
         advance();
         
         auto right = parseComparison(); // 右辺
         auto node = std::make_shared<ASTNode>(NodeType::LogicalExpression, op);
+        node->op = opType;
         node->children.push_back(std::move(left));
         node->children.push_back(std::move(right));
         left = std::move(node);
@@ -647,6 +644,12 @@ std::shared_ptr<ASTNode> Parser::parseOutputStatement() {
     debugLog("出力文を解析中...");
     auto node = std::make_shared<ASTNode>(NodeType::OutputStatement);
     advance(); // "<" をスキップ
+
+    // 式のない "<;" は溜めた出力を流す
+    if (pos < tokens.size() && tokens[pos].type == TokenType::Semicolon) {
+        advance();
+        return node;
+    }
     
     // 出力する式を解析
     auto expr = parseExpression();
@@ -694,9 +697,18 @@ std::shared_ptr<ASTNode> Parser::parseFileOutputStatement() {
     debugLog("ファイル出力文を解析中...");
     auto node = std::make_shared<ASTNode>(NodeType::FileOutputStatement);
 
+    // ファイル名のない "<<;" はメモリマップをファイルに同期する
+    if (tokens[pos].type == TokenType::DoubleLAngleBracket && pos + 1 < tokens.size() &&
+        tokens[pos + 1].type == TokenType::Semicolon) {
+        advance(); // "<<"
+        advance(); // セミコロンをスキップ
+        return node;
+    }
+
     // ファイル名の解析（文字列かメモリ参照）
     if (tokens[pos].type == TokenType::String) {
         auto fileNode = std::make_shared<ASTNode>(NodeType::String, tokens[pos].value);
+        fileNode->constant = constants.string(tokens[pos].value);
         advance(); // 文字列をスキップ
         node->children.push_back(std::move(fileNode));
     } 
@@ -734,6 +746,7 @@ std::shared_ptr<ASTNode> Parser::parseFileOutputStatement() {
     } 
     else if (tokens[pos].type == TokenType::String) {
         auto strNode = std::make_shared<ASTNode>(NodeType::String, tokens[pos].value);
+        strNode->constant = constants.string(tokens[pos].value);
         advance(); // 文字列をスキップ
         node->children.push_back(std::move(strNode));
     } 
@@ -761,6 +774,7 @@ std::shared_ptr<ASTNode> Parser::parseFileInputStatement() {
     // ファイル名の解析（文字列かメモリ参照）
     if (tokens[pos].type == TokenType::String) {
         auto fileNode = std::make_shared<ASTNode>(NodeType::String, tokens[pos].value);
+        fileNode->constant = constants.string(tokens[pos].value);
         advance(); // 文字列をスキップ
         node->children.push_back(std::move(fileNode));
     } 
@@ -890,16 +904,13 @@ std::shared_ptr<ASTNode> Parser::parseCast() {
     debugLog("型変換を解析中...");
     
     // キャスト種類を保存
-    std::string castType;
-    if (tokens[pos].type == TokenType::IntCast) castType = "int";
-    else if (tokens[pos].type == TokenType::FloatCast) castType = "float";
-    else if (tokens[pos].type == TokenType::StrCast) castType = "string";
-    else if (tokens[pos].type == TokenType::BoolCast) castType = "bool";
-    else {
+    Operator castType = tokenToOperator(tokens[pos].type);
+    if (castType < Operator::IntCast || castType > Operator::BoolCast) {
         return recoverFromError("Expected cast type (int, float, string, bool)");
     }
     
-    auto node = std::make_shared<ASTNode>(NodeType::Cast, castType);
+    auto node = std::make_shared<ASTNode>(NodeType::Cast, operator2String(castType));
+    node->op = castType;
     advance(); // キャストトークンをスキップ
     
     // キャストする対象の式
@@ -917,14 +928,13 @@ std::shared_ptr<ASTNode> Parser::parseCharCodeCast() {
     debugLog("文字コード変換を解析中...");
     
     // 変換種類を保存
-    std::string castType;
-    if (tokens[pos].type == TokenType::CharCodeToInt) castType = "charToInt";
-    else if (tokens[pos].type == TokenType::IntToCharCode) castType = "intToChar";
-    else {
+    Operator castType = tokenToOperator(tokens[pos].type);
+    if (castType != Operator::CharToInt && castType != Operator::IntToChar) {
         return recoverFromError("Expected char code cast type");
     }
     
-    auto node = std::make_shared<ASTNode>(NodeType::CharCodeCast, castType);
+    auto node = std::make_shared<ASTNode>(NodeType::CharCodeCast, operator2String(castType));
+    node->op = castType;
     advance(); // キャストトークンをスキップ
     
     // 変換する対象の式
@@ -940,22 +950,15 @@ std::shared_ptr<ASTNode> Parser::parseCharCodeCast() {
 std::shared_ptr<ASTNode> Parser::parseStackOperation() {
     debugLog("スタック操作を解析中...");
 
-    std::string operation;
-    if (tokens[pos].type == TokenType::IntegerStackPush) operation = "IntegerStackPush";
-    else if (tokens[pos].type == TokenType::IntegerStackPop) operation = "IntegerStackPop";
-    else if (tokens[pos].type == TokenType::FloatStackPush) operation = "FloatStackPush";
-    else if (tokens[pos].type == TokenType::FloatStackPop) operation = "FloatStackPop";
-    else if (tokens[pos].type == TokenType::StringStackPush) operation = "StringStackPush";
-    else if (tokens[pos].type == TokenType::StringStackPop) operation = "StringStackPop";
-    else if (tokens[pos].type == TokenType::BooleanStackPush) operation = "BooleanStackPush";
-    else if (tokens[pos].type == TokenType::BooleanStackPop) operation = "BooleanStackPop";
-    else {
+    Operator operation = tokenToOperator(tokens[pos].type);
+    if (operation < Operator::IntegerStackPush) {
         return recoverFromError("Expected stack operation");
     }
 
     advance(); // スタック操作トークンをスキップ
 
-    auto node = std::make_shared<ASTNode>(NodeType::StackOperation, operation);
+    auto node = std::make_shared<ASTNode>(NodeType::StackOperation, operator2String(operation));
+    node->op = operation;
     node->children.push_back(parseExpression());
 
     // セミコロンチェック
@@ -1002,6 +1005,41 @@ std::shared_ptr<ASTNode> Parser::parseMapWindowSlide() {
     return node;
 }
 
+// トークンを演算子に変換
+Operator Parser::tokenToOperator(TokenType type) {
+    switch (type) {
+        case TokenType::Plus: case TokenType::PlusEqual: return Operator::Add;
+        case TokenType::Minus: case TokenType::MinusEqual: return Operator::Subtract;
+        case TokenType::Multiply: case TokenType::MultiplyEqual: return Operator::Multiply;
+        case TokenType::Divide: case TokenType::DivideEqual: return Operator::Divide;
+        case TokenType::Modulus: case TokenType::ModulusEqual: return Operator::Modulus;
+        case TokenType::EqualTo: return Operator::Equal;
+        case TokenType::NotEqualTo: return Operator::NotEqual;
+        case TokenType::LAngleBracket: return Operator::Less;
+        case TokenType::LessThanOrEqual: return Operator::LessEqual;
+        case TokenType::RAngleBracket: return Operator::Greater;
+        case TokenType::GreaterThanOrEqual: return Operator::GreaterEqual;
+        case TokenType::And: return Operator::And;
+        case TokenType::Or: return Operator::Or;
+        case TokenType::Not: return Operator::Not;
+        case TokenType::IntCast: return Operator::IntCast;
+        case TokenType::FloatCast: return Operator::FloatCast;
+        case TokenType::StrCast: return Operator::StringCast;
+        case TokenType::BoolCast: return Operator::BoolCast;
+        case TokenType::CharCodeToInt: return Operator::CharToInt;
+        case TokenType::IntToCharCode: return Operator::IntToChar;
+        case TokenType::IntegerStackPush: return Operator::IntegerStackPush;
+        case TokenType::IntegerStackPop: return Operator::IntegerStackPop;
+        case TokenType::FloatStackPush: return Operator::FloatStackPush;
+        case TokenType::FloatStackPop: return Operator::FloatStackPop;
+        case TokenType::StringStackPush: return Operator::StringStackPush;
+        case TokenType::StringStackPop: return Operator::StringStackPop;
+        case TokenType::BooleanStackPush: return Operator::BooleanStackPush;
+        case TokenType::BooleanStackPop: return Operator::BooleanStackPop;
+        default: return Operator::None;
+    }
+}
+
 std::shared_ptr<ASTNode> Parser::recoverFromError(const std::string& message) {
     reportError(message);
     synchronize(); // 次のポイントまでスキップ
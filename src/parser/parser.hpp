@@ -17,6 +17,7 @@ private:
     bool hasError = false;      // エラーフラグ
     bool debugMode = false;    // デバッグモード
     std::vector<std::string> errors; // エラーリスト
+    ConstantPool constants;     // リテラル定数
 
 public:
     Parser(const std::vector<Token>& tokens, bool debug = false) 
@@ -90,9 +91,10 @@ public:
 
     // エラー関連
     bool hasErrors() const { return !errors.empty(); }
-    void printErrors() const {
+    const std::vector<std::string>& getErrors() const { return errors; }
+    void printErrors(std::ostream& out = std::cerr) const {
         for (const auto& error : errors) {
-            std::cerr << error << std::endl;
+            out << error << std::endl;
         }
     }
 
@@ -109,6 +111,7 @@ private:
         }
         hasError = true;
     }
+    static Operator tokenToOperator(TokenType type);                     // トークンを演算子に変換
     std::shared_ptr<ASTNode> recoverFromError(const std::string& message); // エラーから回復
     void synchronize();
     void debugLog(const std::string& message) {
@@ -0,0 +1,163 @@
+// SigNum Buffered Input Reader
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include "reader.hpp"
+// POSIX環境では標準入力をファイル記述子から直接読む（それ以外はストリームのバッファから読む）
+#if defined(__unix__) || defined(__APPLE__)
+#define SIGNUM_READ_SUPPORTED 1
+#include <unistd.h>
+#endif
+
+namespace {
+
+// 起動時の標準入力のバッファ（差し替えられていなければファイル記述子から直接読める）
+std::streambuf* const standardInputBuffer = std::cin.rdbuf();
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+} // namespace
+
+InputReader::InputReader(std::istream& stream)
+    : source(stream.rdbuf()), buffer(INPUT_BUFFER_SIZE) {
+    // 標準入力は届いた分だけ読む（パイプの先が書くたびに処理できるように）
+    // 常駐サーバーの子プロセスのように rdbuf を差し替えていれば、そのバッファから読む
+#ifdef SIGNUM_READ_SUPPORTED
+    if (&stream == &std::cin && source == standardInputBuffer) {
+        descriptor = STDIN_FILENO;
+    }
+#endif
+}
+
+// バッファを読み足す（まだ読み進めていない分は先頭に寄せて残す）
+bool InputReader::fill() {
+    if (eof) {
+        return false;
+    }
+    size_t kept = length - position;
+    std::memmove(buffer.data(), buffer.data() + position, kept);
+    char* target = buffer.data() + kept;
+    size_t room = buffer.size() - kept;
+    std::streamsize count = 0;
+#ifdef SIGNUM_READ_SUPPORTED
+    if (descriptor >= 0) {
+        ssize_t received;
+        do {
+            received = ::read(descriptor, target, room);
+        } while (received < 0 && errno == EINTR);
+        count = received > 0 ? static_cast<std::streamsize>(received) : 0;
+    }
+    else
+#endif
+    if (source && source->sgetc() != std::char_traits<char>::eof()) {
+        // 1文字届くまで待ち、その後はバッファに溜まっている分だけ読む（一杯になるまで待たない）
+        std::streamsize available = std::max<std::streamsize>(source->in_avail(), 1);
+        count = source->sgetn(target, std::min(available, static_cast<std::streamsize>(room)));
+    }
+    position = 0;
+    length = kept + (count > 0 ? static_cast<size_t>(count) : 0);
+    if (count <= 0) {
+        eof = true;
+    }
+    return count > 0;
+}
+
+// 1行読み込む
+bool InputReader::readLine(std::string& line) {
+    line.clear();
+    bool any = false;
+    while (position < length || fill()) {
+        any = true;
+        const char* start = buffer.data() + position;
+        const char* newline = static_cast<const char*>(std::memchr(start, '\n', length - position));
+        if (newline) {
+            line.append(start, newline);
+            position += static_cast<size_t>(newline - start) + 1;
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            return true;
+        }
+        line.append(start, length - position);
+        position = length;
+    }
+    if (!line.empty() && line.back() == '\r') {
+        line.pop_back();
+    }
+    return any;
+}
+
+// 空白で区切られた語を1つ読み込む
+bool InputReader::readToken(std::string& token) {
+    token.clear();
+    // 先頭の空白を読み飛ばす
+    for (;;) {
+        if (position == length && !fill()) {
+            return false;
+        }
+        if (!isSpace(buffer[position])) {
+            break;
+        }
+        ++position;
+    }
+    // 語の終わりまで読む（バッファの境目をまたぐときは読み足す）
+    while (position < length || fill()) {
+        const char* start = buffer.data() + position;
+        const char* end = buffer.data() + length;
+        const char* p = start;
+        while (p < end && !isSpace(*p)) {
+            ++p;
+        }
+        token.append(start, p);
+        position += static_cast<size_t>(p - start);
+        if (p < end) {
+            break;
+        }
+    }
+    skipBlankLineEnd();
+    return true;
+}
+
+// 行の残りが空白だけなら改行まで読み飛ばす（空白の後に文字が続けば、空白も読み進めずに残す）
+void InputReader::skipBlankLineEnd() {
+    size_t scan = position;
+    for (;;) {
+        if (scan == length) {
+            // バッファが空白で埋まっていれば、それ以上は先を見ない
+            if (length - position == buffer.size()) {
+                return;
+            }
+            size_t offset = scan - position;
+            if (!fill()) {
+                // 入力の終わりまで空白だけ
+                position = length;
+                return;
+            }
+            scan = position + offset;
+            continue;
+        }
+        char c = buffer[scan];
+        if (c == '\n') {
+            position = scan + 1;
+            return;
+        }
+        if (c != ' ' && c != '\t' && c != '\r') {
+            return;
+        }
+        ++scan;
+    }
+}
+
+// 入力元が端末か
+bool InputReader::isTerminal(const std::istream& stream) {
+#ifdef SIGNUM_READ_SUPPORTED
+    return &stream == &std::cin && stream.rdbuf() == standardInputBuffer && isatty(STDIN_FILENO);
+#else
+    (void)stream;
+    return false;
+#endif
+}
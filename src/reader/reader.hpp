@@ -0,0 +1,39 @@
+// SigNum Buffered Input Reader
+
+#pragma once
+
+#include <istream>
+#include <string>
+#include <vector>
+
+// 入力の読み込みバッファのサイズ
+constexpr size_t INPUT_BUFFER_SIZE = 1 << 16;
+
+// 入力ストリームを大きな塊で読み込んで行単位・語単位で切り出す
+// （std::cin >> や std::getline の1文字ずつの処理を避ける）
+class InputReader {
+private:
+    std::streambuf* source;
+    int descriptor = -1; // 標準入力ならファイル記述子から直接読む
+    std::vector<char> buffer;
+    size_t position = 0;
+    size_t length = 0;
+    bool eof = false;
+
+    // バッファを読み足す（まだ読み進めていない分は残す。もう読めなければfalse）
+    bool fill();
+    // 行の残りが空白だけなら改行まで読み飛ばす（そうでなければ何も読み進めない）
+    void skipBlankLineEnd();
+
+public:
+    explicit InputReader(std::istream& stream);
+
+    // 1行読み込む（改行と直前の\rは含めない。入力が尽きていればfalse）
+    bool readLine(std::string& line);
+    // 空白で区切られた語を1つ読み込む（入力が尽きていればfalse）
+    // 語の後ろが行末まで空白なら改行も読み飛ばすので、続けて readLine で次の行を読める
+    bool readToken(std::string& token);
+
+    // 入力元が端末か（端末なら入力を促して対話的に読む）
+    static bool isTerminal(const std::istream& stream);
+};
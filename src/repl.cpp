@@ -120,8 +120,11 @@ void REPL::executeCode(const std::string& code) {
         }
     }
     catch (const std::exception& e) {
+        interpreter.flushOutput();
         std::cout << "Error: " << e.what() << std::endl;
     }
+    // 入力ごとに結果を表示する
+    interpreter.flushOutput();
 }
 
 void REPL::stop() {
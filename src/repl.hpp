@@ -13,7 +13,8 @@ private:
     void executeCode(const std::string& code);
 
 public:
-    REPL() = default;
+    // REPL自身が標準入力を行ごとに読むので、入力文も常に対話的に読む
+    REPL() { interpreter.setInputPrompt(true); }
     void start();
     void stop();
 };
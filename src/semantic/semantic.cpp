@@ -1,5 +1,6 @@
 // SigNum Semantic Analyzer
 #include "semantic.hpp"
+#include "../native/native.hpp"
 #include <iostream>
 
 std::string memoryTypeToString(MemoryType type) {
@@ -136,7 +137,10 @@ MemoryType SemanticAnalyzer::visitNode(const ASTNode* node) {
             return MemoryType::Integer;
         
         case NodeType::FileOutputStatement:
-            checkFileInputOutput(node);
+            // 同期文 "<<;" はオペランドを持たない
+            if (!node->children.empty()) {
+                checkFileInputOutput(node);
+            }
             return MemoryType::Integer;
 
         case NodeType::StackOperation:
@@ -203,9 +207,9 @@ MemoryType SemanticAnalyzer::checkMemoryMapRef(const ASTNode* node) {
             if (index < 0) {
                 reportError("Memory map index must be non-negative: " + mapRef);
             }
-            // 最大1024要素なので、インデックスは0-1023まで有効
-            if (index >= 1024) {
-                reportError("Memory map index out of range (max 1023): " + mapRef);
+            // インデックスはウィンドウの要素数未満まで有効（既定は0-1023）
+            if (index >= 0 && static_cast<size_t>(index) >= mapWindowSize) {
+                reportError("Memory map index out of range (max " + std::to_string(mapWindowSize - 1) + "): " + mapRef);
             }
             
             // 既に型が記録されている場合は、その型を返す
@@ -534,6 +538,9 @@ void SemanticAnalyzer::checkFunctionDefinition(const ASTNode* node) {
         if (funcIDInt < 1 || funcIDInt > 999) {
             reportError("Function ID: " + funcID + " is not in range 001-999");
             idError = true;
+        } else if (NativeRegistry::find(funcIDInt)) {
+            reportError("Function ID: " + funcID + " is reserved for a native function");
+            idError = true;
         }
     } 
     catch (const std::exception& e) {
@@ -562,7 +569,15 @@ void SemanticAnalyzer::checkFunctionDefinition(const ASTNode* node) {
 void SemanticAnalyzer::checkFunctionCall(const ASTNode* node) {
     std::string funcID = node->value;
     
-    // 関数が定義されているかチェック
+    // 関数が定義されているかチェック（ネイティブ関数は登録済みなら定義済み）
+    bool native = false;
+    try {
+        native = NativeRegistry::find(std::stoi(funcID)) != nullptr;
+    } catch (const std::exception&) {
+    }
+    if (native) {
+        return;
+    }
     if (functions.count(funcID) == 0 || !functions[funcID].isDefined) {
         reportError("Function " + funcID + " is not defined");
     }
@@ -735,5 +750,7 @@ MemoryType SemanticAnalyzer::checkMapWindowSlide(const ASTNode* node) {
 // エラー報告
 void SemanticAnalyzer::reportError(const std::string& message) {
     errors.push_back(message);
-    std::cerr << "Semantic error: " << message << std::endl;
+    if (verbose) {
+        std::cerr << "Semantic error: " << message << std::endl;
+    }
 }
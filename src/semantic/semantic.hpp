@@ -39,6 +39,7 @@ private:
     
     // エラーメッセージを保存
     std::vector<std::string> errors;
+    bool verbose = true; // エラーを標準エラーにも表示する
 
     // スタックカウント
     size_t intStackSize = 0;
@@ -46,6 +47,9 @@ private:
     size_t stringStackSize = 0;
     size_t booleanStackSize = 0;
 
+    // メモリマップのウィンドウの要素数（既定はInterpreterの MEMORY_MAP_SIZE と同じ）
+    size_t mapWindowSize = 1024;
+
 public:
     // コンストラクタ
     SemanticAnalyzer() = default;
@@ -53,6 +57,22 @@ public:
     // 意味解析関数
     bool analyze(const std::shared_ptr<ASTNode>& root);
     
+    // プログラムの外で定義済みの関数を登録（スナップショットから復元するものなど）
+    void declareFunction(const std::string& funcID) { functions[funcID] = {funcID, true}; }
+    // 実行開始時のスタックの要素数を設定（スナップショットから復元するものなど）
+    void presetStackSizes(size_t intSize, size_t floatSize, size_t stringSize, size_t booleanSize) {
+        intStackSize = intSize;
+        floatStackSize = floatSize;
+        stringStackSize = stringSize;
+        booleanStackSize = booleanSize;
+    }
+
+    // メモリマップのウィンドウの要素数を設定（インデックスの範囲チェックに使う）
+    void setMapWindowSize(size_t size) { mapWindowSize = size; }
+
+    // エラーを標準エラーに表示するか
+    void setVerbose(bool enabled) { verbose = enabled; }
+
     // エラー取得
     const std::vector<std::string>& getErrors() const { return errors; }
     
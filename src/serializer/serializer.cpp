@@ -0,0 +1,261 @@
+// SigNum Precompiled Program (.sgnc)
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+#include "serializer.hpp"
+#include "../version.hpp"
+
+static_assert(sizeof(ProgramSerializer::Header) == 56, "unexpected .sgnc header layout");
+static_assert(sizeof(ProgramSerializer::Node) == 48, "unexpected .sgnc node layout");
+
+// 内容のハッシュ（FNV-1a 64bit）
+uint64_t ProgramSerializer::hash(const char* data, size_t size) {
+    uint64_t value = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; ++i) {
+        value ^= static_cast<unsigned char>(data[i]);
+        value *= 1099511628211ULL;
+    }
+    return value;
+}
+
+namespace {
+
+// 文字列表（同じ文字列は共有する）
+class StringTable {
+private:
+    std::string bytes;
+    std::unordered_map<std::string, uint32_t> offsets;
+
+public:
+    uint32_t add(const std::string& str) {
+        auto it = offsets.find(str);
+        if (it != offsets.end()) {
+            return it->second;
+        }
+        uint32_t offset = static_cast<uint32_t>(bytes.size());
+        bytes += str;
+        offsets.emplace(str, offset);
+        return offset;
+    }
+
+    const std::string& data() const { return bytes; }
+};
+
+// 文字列表の範囲を取り出す
+std::string readString(const char* strings, uint32_t stringBytes, uint32_t offset, uint32_t length) {
+    if (offset > stringBytes || length > stringBytes - offset) {
+        throw std::runtime_error("Invalid precompiled file: string out of range");
+    }
+    return std::string(strings + offset, length);
+}
+
+} // namespace
+
+// ASTを .sgnc の内容に変換
+std::string ProgramSerializer::serialize(const std::shared_ptr<ASTNode>& program, const std::string& source,
+                                         const std::string& sourceName) {
+    StringTable strings;
+    std::vector<Node> records;
+
+    // 幅優先で並べて、各ノードの子を連続させる
+    std::vector<const ASTNode*> order{program.get()};
+    for (size_t i = 0; i < order.size(); ++i) {
+        const ASTNode* node = order[i];
+        Node record{};
+        record.type = static_cast<uint8_t>(node->type);
+        record.op = static_cast<uint8_t>(node->op);
+        record.value = strings.add(node->value);
+        record.valueLength = static_cast<uint32_t>(node->value.size());
+
+        const MemoryDescriptor& mem = node->memory;
+        record.memoryType = static_cast<uint8_t>(mem.type);
+        record.memoryIndex = mem.index;
+        record.indirection = strings.add(mem.indirection);
+        record.indirectionLength = static_cast<uint32_t>(mem.indirection.size());
+        if (mem.valid) record.flags |= NODE_MEMORY_VALID;
+        if (mem.isMap) record.flags |= NODE_MEMORY_MAP;
+
+        if (node->constant) {
+            record.flags |= NODE_CONSTANT;
+            const Value& value = *node->constant;
+            if (const int* number = std::get_if<int>(&value)) {
+                record.constantType = CONSTANT_INT;
+                record.constant = static_cast<uint64_t>(static_cast<int64_t>(*number));
+            } else if (const double* number = std::get_if<double>(&value)) {
+                record.constantType = CONSTANT_FLOAT;
+                std::memcpy(&record.constant, number, sizeof(double));
+            } else if (const bool* flag = std::get_if<bool>(&value)) {
+                record.constantType = CONSTANT_BOOL;
+                record.constant = *flag ? 1 : 0;
+            } else {
+                const std::string& str = std::get<std::string>(value);
+                record.constantType = CONSTANT_STRING;
+                record.constant = (static_cast<uint64_t>(strings.add(str)) << 32) | static_cast<uint32_t>(str.size());
+            }
+        }
+
+        record.firstChild = static_cast<uint32_t>(order.size());
+        record.childCount = static_cast<uint32_t>(node->children.size());
+        for (const auto& child : node->children) {
+            order.push_back(child.get());
+        }
+        records.push_back(record);
+    }
+
+    Header header{};
+    std::memcpy(header.magic, "SGNC", 4);
+    header.format = SGNC_FORMAT_VERSION;
+    header.byteOrder = 0x0102;
+    std::strncpy(header.version, SigNum::VERSION.c_str(), sizeof(header.version) - 1);
+    header.sourceHash = hash(source.data(), source.size());
+    header.sourceName = strings.add(sourceName);
+    header.sourceNameLength = static_cast<uint32_t>(sourceName.size());
+    header.nodeCount = static_cast<uint32_t>(records.size());
+    header.stringBytes = static_cast<uint32_t>(strings.data().size());
+
+    std::string body(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(Node));
+    body += strings.data();
+    header.checksum = hash(body.data(), body.size());
+
+    return std::string(reinterpret_cast<const char*>(&header), sizeof(header)) + body;
+}
+
+// .sgnc の内容からASTを復元
+std::shared_ptr<ASTNode> ProgramSerializer::deserialize(const char* data, size_t size, Header& header) {
+    if (size < sizeof(Header)) {
+        throw std::runtime_error("Invalid precompiled file: too short");
+    }
+    std::memcpy(&header, data, sizeof(Header));
+    if (std::memcmp(header.magic, "SGNC", 4) != 0) {
+        throw std::runtime_error("Invalid precompiled file: bad magic");
+    }
+    if (header.byteOrder != 0x0102) {
+        throw std::runtime_error("Precompiled file was built on a machine with a different byte order");
+    }
+    const void* terminator = std::memchr(header.version, '\0', sizeof(header.version));
+    std::string version(header.version, terminator ? static_cast<const char*>(terminator) - header.version
+                                                   : sizeof(header.version));
+    if (header.format != SGNC_FORMAT_VERSION || version != SigNum::VERSION) {
+        throw std::runtime_error("Precompiled file was built by SigNum " + version + " (format " +
+                                 std::to_string(header.format) + "), please recompile with " + SigNum::VERSION);
+    }
+
+    const char* body = data + sizeof(Header);
+    size_t bodySize = size - sizeof(Header);
+    if (header.nodeCount == 0 ||
+        bodySize != static_cast<size_t>(header.nodeCount) * sizeof(Node) + header.stringBytes) {
+        throw std::runtime_error("Invalid precompiled file: size mismatch");
+    }
+    if (hash(body, bodySize) != header.checksum) {
+        throw std::runtime_error("Invalid precompiled file: checksum mismatch");
+    }
+
+    const char* strings = body + static_cast<size_t>(header.nodeCount) * sizeof(Node);
+    std::vector<std::shared_ptr<ASTNode>> nodes(header.nodeCount);
+    std::vector<Node> records(header.nodeCount);
+    std::memcpy(records.data(), body, records.size() * sizeof(Node));
+
+    for (uint32_t i = 0; i < header.nodeCount; ++i) {
+        const Node& record = records[i];
+        if (record.type > static_cast<uint8_t>(NodeType::Error) ||
+            record.op > static_cast<uint8_t>(Operator::BooleanStackPop)) {
+            throw std::runtime_error("Invalid precompiled file: unknown node");
+        }
+        auto node = std::make_shared<ASTNode>(static_cast<NodeType>(record.type),
+                                              readString(strings, header.stringBytes, record.value, record.valueLength));
+        node->op = static_cast<Operator>(record.op);
+
+        MemoryDescriptor& mem = node->memory;
+        mem.valid = (record.flags & NODE_MEMORY_VALID) != 0;
+        mem.isMap = (record.flags & NODE_MEMORY_MAP) != 0;
+        mem.type = static_cast<char>(record.memoryType);
+        mem.index = record.memoryIndex;
+        mem.indirection = readString(strings, header.stringBytes, record.indirection, record.indirectionLength);
+
+        if (record.flags & NODE_CONSTANT) {
+            switch (record.constantType) {
+                case CONSTANT_INT:
+                    node->constant = std::make_shared<const Value>(static_cast<int>(static_cast<int64_t>(record.constant)));
+                    break;
+                case CONSTANT_FLOAT: {
+                    double number;
+                    std::memcpy(&number, &record.constant, sizeof(double));
+                    node->constant = std::make_shared<const Value>(number);
+                    break;
+                }
+                case CONSTANT_BOOL:
+                    node->constant = std::make_shared<const Value>(record.constant != 0);
+                    break;
+                case CONSTANT_STRING:
+                    node->constant = std::make_shared<const Value>(
+                        readString(strings, header.stringBytes, static_cast<uint32_t>(record.constant >> 32),
+                                   static_cast<uint32_t>(record.constant)));
+                    break;
+                default:
+                    throw std::runtime_error("Invalid precompiled file: unknown constant");
+            }
+        }
+        nodes[i] = node;
+    }
+
+    // 子は必ず親より後ろにある（循環しない）
+    for (uint32_t i = 0; i < header.nodeCount; ++i) {
+        const Node& record = records[i];
+        if (record.childCount > 0 &&
+            (record.firstChild <= i || record.firstChild > header.nodeCount ||
+             record.childCount > header.nodeCount - record.firstChild)) {
+            throw std::runtime_error("Invalid precompiled file: child out of range");
+        }
+        auto& children = nodes[i]->children;
+        children.reserve(record.childCount);
+        for (uint32_t c = 0; c < record.childCount; ++c) {
+            children.push_back(nodes[record.firstChild + c]);
+        }
+    }
+    return nodes[0];
+}
+
+// ファイルに保存
+void ProgramSerializer::save(const std::shared_ptr<ASTNode>& program, const std::string& path,
+                             const std::string& source, const std::string& sourceName) {
+    std::string data = serialize(program, source, sourceName);
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Failed to open file for writing: " + path);
+    }
+    file.write(data.data(), data.size());
+    if (!file) {
+        throw std::runtime_error("Failed to write precompiled file: " + path);
+    }
+}
+
+// ファイルから読み込み
+std::shared_ptr<ASTNode> ProgramSerializer::load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Failed to open file: " + path);
+    }
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    Header header;
+    std::shared_ptr<ASTNode> program = deserialize(data.data(), data.size(), header);
+
+    // 元ソースが隣にあれば内容が変わっていないか確かめる
+    const char* strings = data.data() + sizeof(Header) + static_cast<size_t>(header.nodeCount) * sizeof(Node);
+    std::string sourceName = readString(strings, header.stringBytes, header.sourceName, header.sourceNameLength);
+    if (!sourceName.empty()) {
+        size_t slash = path.find_last_of("/\\");
+        std::string sourcePath = (slash == std::string::npos ? "" : path.substr(0, slash + 1)) + sourceName;
+        std::ifstream sourceFile(sourcePath);
+        if (sourceFile) {
+            std::string source((std::istreambuf_iterator<char>(sourceFile)), std::istreambuf_iterator<char>());
+            if (hash(source.data(), source.size()) != header.sourceHash) {
+                throw std::runtime_error("Precompiled file is stale: " + sourcePath + " has changed, please recompile");
+            }
+        }
+    }
+    return program;
+}
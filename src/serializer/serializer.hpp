@@ -0,0 +1,74 @@
+// SigNum Precompiled Program (.sgnc)
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "../ast/ast.hpp"
+
+// .sgncファイルの形式の版（レイアウトを変えたら上げる）
+constexpr uint16_t SGNC_FORMAT_VERSION = 1;
+
+// 検査済みのASTを .sgnc 形式で保存・読み込みする
+// レイアウトはポインタを含まない固定長レコードなので、そのままメモリマップできる
+//   [ヘッダ][ノード配列（幅優先順、子は連続）][文字列表]
+// ヘッダには処理系のバージョン・本体のチェックサム・元ソースのハッシュを持つ
+class ProgramSerializer {
+public:
+    // ヘッダ
+    struct Header {
+        char magic[4];          // "SGNC"
+        uint16_t format;        // SGNC_FORMAT_VERSION
+        uint16_t byteOrder;     // 0x0102（作成したマシンのバイト順）
+        char version[16];       // SigNum::VERSION
+        uint64_t checksum;      // ノード配列と文字列表のハッシュ
+        uint64_t sourceHash;    // 元ソースのハッシュ
+        uint32_t sourceName;    // 元ソースのファイル名（文字列表のオフセット）
+        uint32_t sourceNameLength;
+        uint32_t nodeCount;
+        uint32_t stringBytes;
+    };
+
+    // ノード
+    struct Node {
+        uint64_t constant;        // 定数値（int・double・boolはビット列、文字列はオフセット<<32|長さ）
+        int32_t memoryIndex;
+        uint32_t value;           // 文字列表のオフセット
+        uint32_t valueLength;
+        uint32_t indirection;     // ネストされた参照の型記号
+        uint32_t indirectionLength;
+        uint32_t firstChild;      // 子ノードの先頭（ノード配列の添字）
+        uint32_t childCount;
+        uint8_t type;             // NodeType
+        uint8_t op;               // Operator
+        uint8_t memoryType;
+        uint8_t flags;            // NODE_* の組み合わせ
+        uint8_t constantType;     // CONSTANT_*
+        uint8_t reserved[3];
+    };
+
+    static constexpr uint8_t NODE_MEMORY_VALID = 1;
+    static constexpr uint8_t NODE_MEMORY_MAP = 2;
+    static constexpr uint8_t NODE_CONSTANT = 4;
+
+    static constexpr uint8_t CONSTANT_INT = 0;
+    static constexpr uint8_t CONSTANT_FLOAT = 1;
+    static constexpr uint8_t CONSTANT_STRING = 2;
+    static constexpr uint8_t CONSTANT_BOOL = 3;
+
+    // 内容のハッシュ（FNV-1a 64bit）
+    static uint64_t hash(const char* data, size_t size);
+
+    // ASTを .sgnc の内容に変換
+    static std::string serialize(const std::shared_ptr<ASTNode>& program, const std::string& source,
+                                 const std::string& sourceName);
+    // .sgnc の内容からASTを復元（不正・古い形式なら例外）
+    static std::shared_ptr<ASTNode> deserialize(const char* data, size_t size, Header& header);
+
+    // ファイルに保存
+    static void save(const std::shared_ptr<ASTNode>& program, const std::string& path,
+                     const std::string& source, const std::string& sourceName);
+    // ファイルから読み込み（元ソースが隣にあって内容が変わっていれば例外）
+    static std::shared_ptr<ASTNode> load(const std::string& path);
+};
@@ -0,0 +1,399 @@
+// SigNum Script Server
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include "server.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SIGNUM_SERVER_SUPPORTED 1
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <climits>
+#include <cstdlib>
+#endif
+
+#ifdef SIGNUM_SERVER_SUPPORTED
+
+namespace {
+
+// フレームの種類
+constexpr char FRAME_STDOUT = 'o';
+constexpr char FRAME_STDERR = 'e';
+constexpr char FRAME_EXIT = 'x';
+
+bool writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+bool readAll(int fd, char* data, size_t size) {
+    while (size > 0) {
+        ssize_t got = ::read(fd, data, size);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) return false;
+        data += got;
+        size -= static_cast<size_t>(got);
+    }
+    return true;
+}
+
+// 1行読む（後続の標準入力を読みすぎないように1バイトずつ）
+bool readLine(int fd, std::string& line) {
+    line.clear();
+    char c;
+    while (line.size() < 4096) {
+        if (!readAll(fd, &c, 1)) return false;
+        if (c == '\n') return true;
+        line += c;
+    }
+    return false;
+}
+
+bool sendFrame(int fd, char type, const char* data, size_t size) {
+    unsigned char header[5] = {
+        static_cast<unsigned char>(type),
+        static_cast<unsigned char>(size >> 24), static_cast<unsigned char>(size >> 16),
+        static_cast<unsigned char>(size >> 8), static_cast<unsigned char>(size)
+    };
+    return writeAll(fd, reinterpret_cast<const char*>(header), sizeof(header)) && writeAll(fd, data, size);
+}
+
+bool sendExit(int fd, int code) {
+    std::string payload = std::to_string(code);
+    return sendFrame(fd, FRAME_EXIT, payload.data(), payload.size());
+}
+
+// 出力をフレームにして送るストリームバッファ
+class FrameBuffer : public std::streambuf {
+private:
+    int fd;
+    char type;
+    char buffer[4096];
+
+    bool flushBuffer() {
+        size_t size = static_cast<size_t>(pptr() - pbase());
+        setp(buffer, buffer + sizeof(buffer));
+        return size == 0 || sendFrame(fd, type, buffer, size);
+    }
+
+protected:
+    int overflow(int c) override {
+        if (!flushBuffer()) return traits_type::eof();
+        if (c != traits_type::eof()) {
+            *pptr() = static_cast<char>(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    int sync() override {
+        return flushBuffer() ? 0 : -1;
+    }
+
+public:
+    FrameBuffer(int fd, char type) : fd(fd), type(type) {
+        setp(buffer, buffer + sizeof(buffer));
+    }
+};
+
+// ソケットから標準入力を読むストリームバッファ
+class SocketInputBuffer : public std::streambuf {
+private:
+    int fd;
+    char buffer[4096];
+
+protected:
+    int underflow() override {
+        ssize_t got;
+        do {
+            got = ::read(fd, buffer, sizeof(buffer));
+        } while (got < 0 && errno == EINTR);
+        if (got <= 0) return traits_type::eof();
+        setg(buffer, buffer, buffer + got);
+        return traits_type::to_int_type(buffer[0]);
+    }
+
+public:
+    explicit SocketInputBuffer(int fd) : fd(fd) {
+        setg(buffer, buffer, buffer);
+    }
+};
+
+// ソケットアドレスの作成
+sockaddr_un socketAddress(const std::string& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Socket path too long: " + path);
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return address;
+}
+
+} // namespace
+
+ScriptServer::ScriptServer(std::string socketPath, Frontend frontend, Runner runner)
+    : socketPath(std::move(socketPath)), frontend(std::move(frontend)), runner(std::move(runner)) {}
+
+ScriptServer::~ScriptServer() {
+    if (listener >= 0) {
+        ::close(listener);
+        ::unlink(socketPath.c_str());
+    }
+}
+
+// 要求を待ち受ける
+void ScriptServer::serve() {
+    sockaddr_un address = socketAddress(socketPath);
+
+    // 前回のソケットファイルが残っていれば消す
+    struct stat info;
+    if (::stat(socketPath.c_str(), &info) == 0 && S_ISSOCK(info.st_mode)) {
+        ::unlink(socketPath.c_str());
+    }
+
+    listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        throw std::runtime_error("Failed to create socket: " + std::string(std::strerror(errno)));
+    }
+    if (::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+        ::listen(listener, SOMAXCONN) < 0) {
+        throw std::runtime_error("Failed to listen on " + socketPath + ": " + std::strerror(errno));
+    }
+
+    // 子プロセスは自動で回収し、切断されたクライアントへの書き込みでは終了しない
+    ::signal(SIGCHLD, SIG_IGN);
+    ::signal(SIGPIPE, SIG_IGN);
+
+    std::cout << "Serving on " << socketPath << std::endl;
+    while (true) {
+        int client = ::accept(listener, nullptr, nullptr);
+        if (client < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error("Failed to accept connection: " + std::string(std::strerror(errno)));
+        }
+        handle(client);
+        ::close(client);
+    }
+}
+
+// 解析済みのプログラムを取得
+std::shared_ptr<ASTNode> ScriptServer::lookup(const std::string& source, std::string& errors) {
+    size_t key = std::hash<std::string>{}(source);
+    auto it = cache.find(key);
+    if (it != cache.end() && it->second.source == source) {
+        return it->second.program;
+    }
+
+    // 解析中のエラー表示はクライアントに返す
+    std::ostringstream captured;
+    std::streambuf* oldOut = std::cout.rdbuf(captured.rdbuf());
+    std::streambuf* oldErr = std::cerr.rdbuf(captured.rdbuf());
+    std::shared_ptr<ASTNode> program;
+    try {
+        program = frontend(source);
+    }
+    catch (const std::exception& e) {
+        captured << "Error: " << e.what() << std::endl;
+    }
+    std::cout.rdbuf(oldOut);
+    std::cerr.rdbuf(oldErr);
+
+    if (!program) {
+        errors = captured.str();
+        return nullptr;
+    }
+    if (cache.size() >= SERVER_CACHE_SIZE) {
+        cache.clear();
+    }
+    cache[key] = CacheEntry{source, program};
+    return program;
+}
+
+// 1つの接続を処理
+void ScriptServer::handle(int client) {
+    std::string request;
+    if (!readLine(client, request)) {
+        return;
+    }
+
+    std::string source;
+    std::string error;
+    if (request.rfind("RUN ", 0) == 0) {
+        std::string path = request.substr(4);
+        std::ifstream file(path);
+        if (file) {
+            source.assign((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        } else {
+            error = "Error: Could not open file " + path + "\n";
+        }
+    }
+    else if (request.rfind("SOURCE ", 0) == 0) {
+        unsigned long long size = std::strtoull(request.c_str() + 7, nullptr, 10);
+        if (size > SERVER_MAX_SOURCE_SIZE) {
+            return;
+        }
+        source.resize(static_cast<size_t>(size));
+        if (!readAll(client, &source[0], source.size())) {
+            return;
+        }
+    }
+    else {
+        error = "Error: Invalid request\n";
+    }
+
+    std::shared_ptr<ASTNode> program;
+    if (error.empty()) {
+        program = lookup(source, error);
+    }
+    if (!program) {
+        sendFrame(client, FRAME_STDERR, error.data(), error.size());
+        sendExit(client, 1);
+        return;
+    }
+
+    pid_t pid = ::fork();
+    if (pid < 0) {
+        error = "Error: Failed to start script: " + std::string(std::strerror(errno)) + "\n";
+        sendFrame(client, FRAME_STDERR, error.data(), error.size());
+        sendExit(client, 1);
+        return;
+    }
+    if (pid > 0) {
+        return;
+    }
+
+    // 子プロセス：標準入出力をソケットにつないで新しいInterpreterで実行
+    ::close(listener);
+    ::signal(SIGCHLD, SIG_DFL);
+    FrameBuffer out(client, FRAME_STDOUT);
+    FrameBuffer err(client, FRAME_STDERR);
+    SocketInputBuffer in(client);
+    std::cout.rdbuf(&out);
+    std::cerr.rdbuf(&err);
+    std::cin.rdbuf(&in);
+
+    int code = runner(program);
+    std::cout.flush();
+    std::cerr.flush();
+    sendExit(client, code);
+    ::close(client);
+    ::_exit(code);
+}
+
+// サーバーにスクリプトを送って実行する
+int runScriptClient(const std::string& socketPath, const std::string& script, bool sendSource) {
+    std::string request;
+    if (sendSource) {
+        std::ifstream file(script);
+        if (!file) {
+            throw std::runtime_error("Could not open file " + script);
+        }
+        std::string source((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        request = "SOURCE " + std::to_string(source.size()) + "\n" + source;
+    } else {
+        char resolved[PATH_MAX];
+        if (!::realpath(script.c_str(), resolved)) {
+            throw std::runtime_error("Could not open file " + script);
+        }
+        request = "RUN " + std::string(resolved) + "\n";
+    }
+
+    sockaddr_un address = socketAddress(socketPath);
+    int sock = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sock < 0 || ::connect(sock, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        throw std::runtime_error("Failed to connect to " + socketPath + ": " + std::strerror(errno));
+    }
+    ::signal(SIGPIPE, SIG_IGN);
+    if (!writeAll(sock, request.data(), request.size())) {
+        ::close(sock);
+        throw std::runtime_error("Failed to send request to " + socketPath);
+    }
+
+    // 標準入力を転送しながら応答を中継する
+    bool forwarding = true;
+    while (true) {
+        pollfd fds[2] = {{sock, POLLIN, 0}, {STDIN_FILENO, POLLIN, 0}};
+        if (::poll(fds, forwarding ? 2 : 1, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        if (forwarding && (fds[1].revents & (POLLIN | POLLHUP))) {
+            char buffer[4096];
+            ssize_t got = ::read(STDIN_FILENO, buffer, sizeof(buffer));
+            if (got <= 0 || !writeAll(sock, buffer, static_cast<size_t>(got))) {
+                ::shutdown(sock, SHUT_WR);
+                forwarding = false;
+            }
+        }
+
+        if (fds[0].revents & (POLLIN | POLLHUP)) {
+            unsigned char header[5];
+            if (!readAll(sock, reinterpret_cast<char*>(header), sizeof(header))) {
+                break;
+            }
+            size_t size = (static_cast<size_t>(header[1]) << 24) | (static_cast<size_t>(header[2]) << 16) |
+                          (static_cast<size_t>(header[3]) << 8) | header[4];
+            std::string payload(size, '\0');
+            if (size > 0 && !readAll(sock, &payload[0], size)) {
+                break;
+            }
+            switch (static_cast<char>(header[0])) {
+                case FRAME_STDOUT:
+                    std::cout << payload << std::flush;
+                    break;
+                case FRAME_STDERR:
+                    std::cerr << payload << std::flush;
+                    break;
+                case FRAME_EXIT:
+                    ::close(sock);
+                    return std::atoi(payload.c_str());
+                default:
+                    break;
+            }
+        }
+    }
+
+    ::close(sock);
+    throw std::runtime_error("Connection to " + socketPath + " closed unexpectedly");
+}
+
+#else
+
+ScriptServer::ScriptServer(std::string socketPath, Frontend frontend, Runner runner)
+    : socketPath(std::move(socketPath)), frontend(std::move(frontend)), runner(std::move(runner)) {}
+
+ScriptServer::~ScriptServer() = default;
+
+void ScriptServer::serve() {
+    throw std::runtime_error("Server mode is not supported on this platform");
+}
+
+std::shared_ptr<ASTNode> ScriptServer::lookup(const std::string&, std::string&) {
+    return nullptr;
+}
+
+void ScriptServer::handle(int) {}
+
+int runScriptClient(const std::string&, const std::string&, bool) {
+    throw std::runtime_error("Server mode is not supported on this platform");
+}
+
+#endif
@@ -0,0 +1,57 @@
+// SigNum Script Server
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "../ast/ast.hpp"
+
+// ソースを検査済みのASTにする（失敗したらエラーを表示してnullptr）
+using Frontend = std::function<std::shared_ptr<ASTNode>(const std::string& code)>;
+// プログラムを新しいInterpreterで実行して終了コードを返す
+using Runner = std::function<int(const std::shared_ptr<ASTNode>& program)>;
+
+// キャッシュするプログラムの数（超えたら全部捨てる）
+constexpr size_t SERVER_CACHE_SIZE = 256;
+// 受け付けるソースの最大サイズ
+constexpr size_t SERVER_MAX_SOURCE_SIZE = 64 * 1024 * 1024;
+
+// Unixドメインソケットでスクリプトを受け付けて実行する常駐プロセス
+//
+// 要求:  "RUN <絶対パス>\n" または "SOURCE <バイト数>\n<ソース>"、続けてEOFまで標準入力
+// 応答:  フレーム [種類 1byte][長さ 4byte big endian][内容] の列
+//        種類は 'o'（標準出力）、'e'（標準エラー）、'x'（終了コード。最後に1度だけ）
+//
+// 解析済みのプログラムはソースの内容でキャッシュし、実行は要求ごとにforkした
+// 子プロセスの新しいInterpreterで行う
+class ScriptServer {
+private:
+    struct CacheEntry {
+        std::string source;
+        std::shared_ptr<ASTNode> program;
+    };
+
+    std::string socketPath;
+    Frontend frontend;
+    Runner runner;
+    int listener = -1;
+    std::unordered_map<size_t, CacheEntry> cache;
+
+    // 解析済みのプログラムを取得（なければ解析してキャッシュする）
+    std::shared_ptr<ASTNode> lookup(const std::string& source, std::string& errors);
+    // 1つの接続を処理
+    void handle(int client);
+
+public:
+    ScriptServer(std::string socketPath, Frontend frontend, Runner runner);
+    ~ScriptServer();
+
+    // 要求を待ち受ける（戻らない）
+    void serve();
+};
+
+// サーバーにスクリプトを送って実行し、出力を中継して終了コードを返す
+// sendSourceならファイルの内容を、そうでなければ絶対パスを送る
+int runScriptClient(const std::string& socketPath, const std::string& script, bool sendSource);
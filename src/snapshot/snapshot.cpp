@@ -0,0 +1,239 @@
+// SigNum Machine State Snapshot
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include "snapshot.hpp"
+#include "../serializer/serializer.hpp"
+#include "../version.hpp"
+
+namespace {
+
+constexpr size_t VERSION_SIZE = 16;
+constexpr size_t HEADER_SIZE = 4 + 2 + 2 + VERSION_SIZE + 8;
+
+// 本体の書き出し
+class Writer {
+private:
+    std::string bytes;
+
+public:
+    template <typename T>
+    void put(T value) {
+        bytes.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void putString(const std::string& str) {
+        put(static_cast<uint32_t>(str.size()));
+        bytes += str;
+    }
+
+    const std::string& data() const { return bytes; }
+};
+
+// 本体の読み込み（範囲外なら例外）
+class Reader {
+private:
+    const char* data;
+    size_t size;
+    size_t position = 0;
+
+    void require(size_t length) {
+        if (length > size - position) {
+            throw std::runtime_error("Invalid snapshot file: truncated");
+        }
+    }
+
+public:
+    Reader(const char* data, size_t size) : data(data), size(size) {}
+
+    template <typename T>
+    T get() {
+        require(sizeof(T));
+        T value;
+        std::memcpy(&value, data + position, sizeof(T));
+        position += sizeof(T);
+        return value;
+    }
+
+    std::string getString() {
+        uint32_t length = get<uint32_t>();
+        require(length);
+        std::string str(data + position, length);
+        position += length;
+        return str;
+    }
+
+    // スタックなどの要素数（上限を超えていれば例外）
+    uint32_t getCount(size_t limit) {
+        uint32_t count = get<uint32_t>();
+        if (count > limit) {
+            throw std::runtime_error("Invalid snapshot file: too many elements");
+        }
+        return count;
+    }
+
+    bool atEnd() const { return position == size; }
+};
+
+} // namespace
+
+// 状態をファイルに保存
+void StateSnapshot::save(const Interpreter& interpreter, const std::string& path) {
+    Writer body;
+
+    // メモリプール
+    for (int value : interpreter.intPool) body.put(static_cast<int32_t>(value));
+    for (double value : interpreter.floatPool) body.put(value);
+    for (const std::string& value : interpreter.stringPool) body.putString(value);
+    body.put(static_cast<uint64_t>(interpreter.boolPool.to_ullong()));
+
+    // スタック
+    body.put(static_cast<uint32_t>(interpreter.intStack.size()));
+    for (int value : interpreter.intStack) body.put(static_cast<int32_t>(value));
+    body.put(static_cast<uint32_t>(interpreter.floatStack.size()));
+    for (double value : interpreter.floatStack) body.put(value);
+    body.put(static_cast<uint32_t>(interpreter.stringStack.size()));
+    for (const std::string& value : interpreter.stringStack) body.putString(value);
+    body.put(static_cast<uint32_t>(interpreter.booleanStack.size()));
+    for (bool value : interpreter.booleanStack) body.put(static_cast<uint8_t>(value));
+
+    // 関数テーブル
+    body.put(static_cast<uint32_t>(interpreter.functions.size()));
+    for (const auto& [id, node] : interpreter.functions) {
+        body.put(static_cast<int32_t>(id));
+        body.putString(ProgramSerializer::serialize(node, "", ""));
+    }
+
+    // メモリマップ
+    for (const MemoryMap* map : {&interpreter.intMemoryMap, &interpreter.stringMemoryMap,
+                                 &interpreter.floatMemoryMap, &interpreter.boolMemoryMap}) {
+        body.put(map->getMapType());
+        body.put(static_cast<uint64_t>(map->getWindowOffset()));
+        body.putString(map->getFilePath());
+    }
+
+    const std::string& bytes = body.data();
+    char version[VERSION_SIZE] = {};
+    std::strncpy(version, SigNum::VERSION.c_str(), sizeof(version) - 1);
+    uint16_t format = SNAPSHOT_FORMAT_VERSION;
+    uint16_t byteOrder = 0x0102;
+    uint64_t checksum = ProgramSerializer::hash(bytes.data(), bytes.size());
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Failed to open file for writing: " + path);
+    }
+    file.write("SGNS", 4);
+    file.write(reinterpret_cast<const char*>(&format), sizeof(format));
+    file.write(reinterpret_cast<const char*>(&byteOrder), sizeof(byteOrder));
+    file.write(version, sizeof(version));
+    file.write(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+    file.write(bytes.data(), bytes.size());
+    if (!file) {
+        throw std::runtime_error("Failed to write snapshot file: " + path);
+    }
+}
+
+// ファイルから状態を復元
+void StateSnapshot::load(Interpreter& interpreter, const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Failed to open file: " + path);
+    }
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    if (data.size() < HEADER_SIZE || std::memcmp(data.data(), "SGNS", 4) != 0) {
+        throw std::runtime_error("Invalid snapshot file: bad magic");
+    }
+    Reader header(data.data() + 4, HEADER_SIZE - 4);
+    uint16_t format = header.get<uint16_t>();
+    uint16_t byteOrder = header.get<uint16_t>();
+    char versionBytes[VERSION_SIZE];
+    std::memcpy(versionBytes, data.data() + 8, VERSION_SIZE);
+    const void* terminator = std::memchr(versionBytes, '\0', VERSION_SIZE);
+    std::string version(versionBytes, terminator ? static_cast<const char*>(terminator) - versionBytes : VERSION_SIZE);
+    uint64_t checksum;
+    std::memcpy(&checksum, data.data() + 8 + VERSION_SIZE, sizeof(checksum));
+
+    if (byteOrder != 0x0102) {
+        throw std::runtime_error("Snapshot was taken on a machine with a different byte order");
+    }
+    if (format != SNAPSHOT_FORMAT_VERSION || version != SigNum::VERSION) {
+        throw std::runtime_error("Snapshot was taken by SigNum " + version + " (format " + std::to_string(format) +
+                                 "), it cannot be restored by " + SigNum::VERSION);
+    }
+    const char* bytes = data.data() + HEADER_SIZE;
+    size_t size = data.size() - HEADER_SIZE;
+    if (ProgramSerializer::hash(bytes, size) != checksum) {
+        throw std::runtime_error("Invalid snapshot file: checksum mismatch");
+    }
+
+    // 全部読めてから書き戻す（途中で失敗しても状態を壊さない）
+    Reader body(bytes, size);
+    std::array<int, MEMORY_POOL_SIZE> intPool;
+    std::array<double, MEMORY_POOL_SIZE> floatPool;
+    std::array<std::string, MEMORY_POOL_SIZE> stringPool;
+    for (int& value : intPool) value = body.get<int32_t>();
+    for (double& value : floatPool) value = body.get<double>();
+    for (std::string& value : stringPool) value = body.getString();
+    std::bitset<MEMORY_POOL_SIZE> boolPool(body.get<uint64_t>());
+
+    std::vector<int> intStack(body.getCount(STACK_MAX_SIZE));
+    for (int& value : intStack) value = body.get<int32_t>();
+    std::vector<double> floatStack(body.getCount(STACK_MAX_SIZE));
+    for (double& value : floatStack) value = body.get<double>();
+    std::vector<std::string> stringStack(body.getCount(STACK_MAX_SIZE));
+    for (std::string& value : stringStack) value = body.getString();
+    std::vector<bool> booleanStack(body.getCount(STACK_MAX_SIZE));
+    for (size_t i = 0; i < booleanStack.size(); ++i) booleanStack[i] = body.get<uint8_t>() != 0;
+
+    std::unordered_map<int, std::shared_ptr<ASTNode>> functions;
+    uint32_t functionCount = body.getCount(1000);
+    for (uint32_t i = 0; i < functionCount; ++i) {
+        int id = body.get<int32_t>();
+        std::string program = body.getString();
+        ProgramSerializer::Header programHeader;
+        std::shared_ptr<ASTNode> node = ProgramSerializer::deserialize(program.data(), program.size(), programHeader);
+        if (id < 0 || id > 999 || node->type != NodeType::Function) {
+            throw std::runtime_error("Invalid snapshot file: bad function");
+        }
+        functions[id] = node;
+    }
+
+    struct MapState {
+        char type;
+        size_t windowOffset;
+        std::string path;
+    };
+    std::array<MapState, 4> maps;
+    for (MapState& map : maps) {
+        map.type = body.get<char>();
+        map.windowOffset = static_cast<size_t>(body.get<uint64_t>());
+        map.path = body.getString();
+    }
+    if (!body.atEnd()) {
+        throw std::runtime_error("Invalid snapshot file: trailing data");
+    }
+
+    interpreter.intPool = intPool;
+    interpreter.floatPool = floatPool;
+    interpreter.stringPool = std::move(stringPool);
+    interpreter.boolPool = boolPool;
+    interpreter.intStack = std::move(intStack);
+    interpreter.floatStack = std::move(floatStack);
+    interpreter.stringStack = std::move(stringStack);
+    interpreter.booleanStack = std::move(booleanStack);
+    interpreter.functions = std::move(functions);
+    ++interpreter.functionsVersion;
+    interpreter.intStack.reserve(STACK_MAX_SIZE);
+    interpreter.floatStack.reserve(STACK_MAX_SIZE);
+    interpreter.stringStack.reserve(STACK_MAX_SIZE);
+    interpreter.booleanStack.reserve(STACK_MAX_SIZE);
+
+    MemoryMap* targets[] = {&interpreter.intMemoryMap, &interpreter.stringMemoryMap,
+                            &interpreter.floatMemoryMap, &interpreter.boolMemoryMap};
+    for (size_t i = 0; i < maps.size(); ++i) {
+        targets[i]->restore(maps[i].path, maps[i].type, maps[i].windowOffset);
+    }
+}
@@ -0,0 +1,22 @@
+// SigNum Machine State Snapshot
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include "../interpreter/interpreter.hpp"
+
+// スナップショットファイルの形式の版（レイアウトを変えたら上げる）
+constexpr uint16_t SNAPSHOT_FORMAT_VERSION = 1;
+
+// マシンの状態（メモリプール・スタック・関数テーブル・メモリマップ）を保存・復元する
+//   [マジック "SGNS"][形式の版][バイト順][SigNum::VERSION][本体のチェックサム][本体]
+// 関数は .sgnc と同じ形式で本体を持つ。メモリマップはファイルの中身ではなく
+// パス・型・ウィンドウ位置だけを持つ（中身はファイル側に残っている）
+class StateSnapshot {
+public:
+    // 状態をファイルに保存
+    static void save(const Interpreter& interpreter, const std::string& path);
+    // ファイルから状態を復元（不正・古い形式なら例外）
+    static void load(Interpreter& interpreter, const std::string& path);
+};
@@ -0,0 +1,733 @@
+// SigNum C++ Runtime
+// トランスパイルしたC++コードの先頭に埋め込むランタイム
+// メモリプール・スタック・メモリマップ・入出力をInterpreterと同じ挙動で提供する
+
+#include "transpiler.hpp"
+
+const char* const CPP_RUNTIME = R"SIGNUM(
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <variant>
+#include <vector>
+// POSIX環境ではメモリマップをファイルの mmap で実装する（それ以外は読み書きのたびにファイルを開く）
+#if defined(__unix__) || defined(__APPLE__)
+#define SG_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// メモリマップのウィンドウの要素数（--map-window を指定して変換すると先頭で定義される）
+#ifndef SG_MAP_WINDOW
+#define SG_MAP_WINDOW 1024
+#endif
+
+namespace sg {
+
+constexpr std::size_t MEMORY_POOL_SIZE = 64;
+constexpr std::size_t ARGS_START = 48;
+constexpr std::size_t RETURN_START = 56;
+constexpr std::size_t STACK_MAX_SIZE = 1024;
+constexpr std::size_t MEMORY_MAP_SIZE = SG_MAP_WINDOW;
+
+// メモリプール
+int intPool[MEMORY_POOL_SIZE];
+double floatPool[MEMORY_POOL_SIZE];
+std::string stringPool[MEMORY_POOL_SIZE];
+bool boolPool[MEMORY_POOL_SIZE];
+
+// スタック
+std::vector<int> intStack;
+std::vector<double> floatStack;
+std::vector<std::string> stringStack;
+std::vector<bool> booleanStack;
+
+// 関数テーブル（定義文の実行時に登録される）
+void (*functions[1000])();
+
+// インデックスの範囲チェック
+inline int checkIndex(int index) {
+    if (index < 0 || index >= static_cast<int>(MEMORY_POOL_SIZE)) {
+        throw std::out_of_range("Memory index out of range: " + std::to_string(index));
+    }
+    return index;
+}
+
+// 値を文字列に変換
+inline std::string str(int value) { return std::to_string(value); }
+inline std::string str(double value) { return std::to_string(value); }
+inline std::string str(bool value) { return value ? "true" : "false"; }
+inline const std::string& str(const std::string& value) { return value; }
+
+// 出力
+inline void print(int value) { std::cout << value << '\n'; }
+inline void print(double value) { std::cout << std::to_string(value) << '\n'; }
+inline void print(bool value) { std::cout << (value ? "true" : "false") << '\n'; }
+inline void print(const std::string& value) { std::cout << value << '\n'; }
+inline void flush() { std::cout.flush(); }
+
+// 実行時エラー（戻り値の型は式の中で使うため）
+template <typename T>
+[[noreturn]] T fail(const std::string& message) {
+    throw std::runtime_error(message);
+}
+
+// 型の合わない値の取り出し（Interpreterのstd::getと同じ例外）
+template <typename T>
+[[noreturn]] T badVariant() {
+    throw std::bad_variant_access();
+}
+
+// 算術演算
+inline int idiv(int lval, int rval) {
+    if (rval == 0) throw std::runtime_error("Division by zero");
+    return lval / rval;
+}
+
+inline int imod(int lval, int rval) {
+    if (rval == 0) throw std::runtime_error("Modulo by zero");
+    return lval % rval;
+}
+
+inline double fdiv(double lval, double rval) {
+    if (rval == 0.0) throw std::runtime_error("Division by zero");
+    return lval / rval;
+}
+
+// 論理演算（両辺とも評価する）
+inline bool both(bool lval, bool rval) { return lval && rval; }
+inline bool either(bool lval, bool rval) { return lval || rval; }
+
+// 文字列操作
+inline std::string charAt(const std::string& str, int index) {
+    if (index < 0 || index >= static_cast<int>(str.length())) {
+        throw std::out_of_range("String index out of range: " + std::to_string(index) +
+                                " (string length: " + std::to_string(str.length()) + ")");
+    }
+    return std::string(1, str[index]);
+}
+
+inline int charToInt(const std::string& str) {
+    if (str.length() == 1) {
+        return static_cast<int>(static_cast<unsigned char>(str[0]));
+    }
+    throw std::runtime_error("Character code cast requires single character, got: " + str);
+}
+
+inline std::string intToChar(int code) {
+    if (code >= 0 && code <= 127) {
+        return std::string(1, static_cast<char>(code));
+    }
+    throw std::runtime_error("Character code must be in range 0-127, got: " + std::to_string(code));
+}
+
+// 型の合わない代入
+template <typename T>
+[[noreturn]] void typeMismatch(const T& value, char type, int index) {
+    throw std::runtime_error("Type mismatch: cannot store " + str(value) +
+                             " in $" + std::string(1, type) + std::to_string(index));
+}
+
+// スタック操作
+template <typename T>
+inline void push(std::vector<T>& stack, const T& value, const char* name) {
+    if (stack.size() >= STACK_MAX_SIZE) throw std::runtime_error(std::string(name) + " stack overflow");
+    stack.push_back(value);
+}
+
+template <typename T>
+inline T pop(std::vector<T>& stack, const char* name) {
+    if (stack.empty()) throw std::runtime_error(std::string(name) + " stack underflow");
+    T result = std::move(stack.back());
+    stack.pop_back();
+    return result;
+}
+
+// メモリマップ（ファイル上の配列。形式はInterpreterのMemoryMapと同じ）
+// ファイル全体を mmap(MAP_SHARED) でマップし、要素はメモリとして読み書きする
+// 書き込んだページはビットマップに記録し、同期では連続したページごとにまとめて msync する
+// mmap のない環境（POSIX以外）では、読み書きのたびにファイルを開いて読み書きする
+constexpr std::size_t MEMORY_MAP_MAX_OFFSET = static_cast<std::size_t>(std::numeric_limits<std::streamoff>::max());
+
+#ifdef SG_MMAP
+constexpr std::size_t MEMORY_MAP_RESERVE = 1 << 20;
+static const std::size_t MEMORY_PAGE_SIZE = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+
+// ファイルのページごとの印（1ページ1bit。走査は印を付けた語の範囲に限る）
+class PageBitmap {
+private:
+    std::vector<std::uint64_t> words;
+    std::size_t first = 0;
+    std::size_t last = 0;
+
+public:
+    bool empty() const { return first == last; }
+
+    void mark(std::size_t firstPage, std::size_t lastPage) {
+        std::size_t begin = firstPage / 64;
+        std::size_t end = lastPage / 64 + 1;
+        if (words.size() < end) words.resize(end);
+        first = empty() ? begin : std::min(first, begin);
+        last = std::max(last, end);
+        for (std::size_t page = firstPage; page <= lastPage; ++page) {
+            words[page / 64] |= std::uint64_t(1) << (page % 64);
+        }
+    }
+
+    void merge(const PageBitmap& other) {
+        if (other.empty()) return;
+        if (words.size() < other.last) words.resize(other.last);
+        for (std::size_t i = other.first; i < other.last; ++i) words[i] |= other.words[i];
+        first = empty() ? other.first : std::min(first, other.first);
+        last = std::max(last, other.last);
+    }
+
+    void clear() {
+        std::fill(words.begin() + static_cast<std::ptrdiff_t>(first), words.begin() + static_cast<std::ptrdiff_t>(last), 0);
+        first = 0;
+        last = 0;
+    }
+
+    // 印の付いたページの連続した範囲ごとに visit(先頭のページ, ページ数) を呼ぶ（limit 以降のページは除く）
+    template <typename Visit>
+    void forEachRun(std::size_t limit, Visit visit) const {
+        std::size_t end = std::min(last * 64, limit);
+        std::size_t page = first * 64;
+        while (page < end) {
+            std::uint64_t word = words[page / 64] >> (page % 64);
+            if (word == 0) {
+                page = (page / 64 + 1) * 64;
+                continue;
+            }
+            if (!(word & 1)) {
+                ++page;
+                continue;
+            }
+            std::size_t start = page;
+            while (page < end && (words[page / 64] >> (page % 64) & 1)) ++page;
+            visit(start, page - start);
+        }
+    }
+};
+#endif
+
+class MemoryMap {
+private:
+    std::string filePath;
+    char mapType;
+    std::size_t windowOffset = 0;
+    std::size_t fileSize = 0;
+#ifdef SG_MMAP
+    int fd = -1;
+    char* data = nullptr;
+    std::size_t mappedSize = 0;
+    PageBitmap dirtyPages;    // 前回の同期以降に書き込んだページ
+    PageBitmap flushingPages; // 反映を始めたが、ディスクへの書き込みを待っていないページ
+#endif
+
+    // 要素のバイト数
+    std::size_t elementSize() const {
+        return (mapType == '#' || mapType == '~') ? 4 : 1;
+    }
+
+#ifdef SG_MMAP
+    void close() {
+        if (data) {
+            sync(false);
+            munmap(data, mappedSize);
+            data = nullptr;
+        }
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+        mappedSize = 0;
+        fileSize = 0;
+        dirtyPages.clear();
+        flushingPages.clear();
+    }
+
+    // 現在のファイルサイズに合わせてマップし直す
+    void remap() {
+        struct stat status;
+        if (fstat(fd, &status) != 0) {
+            throw std::runtime_error("Failed to stat file: " + filePath);
+        }
+        fileSize = static_cast<std::size_t>(status.st_size);
+        if (data && fileSize <= mappedSize) {
+            return;
+        }
+        std::size_t previousSize = mappedSize;
+        if (data) {
+            munmap(data, mappedSize);
+            data = nullptr;
+            mappedSize = 0;
+        }
+        if (fileSize == 0) {
+            return;
+        }
+        // 伸ばすときは前の倍まで取り、大きなファイルでも作り直しは数回で済ませる
+        std::size_t size = (fileSize + MEMORY_MAP_RESERVE - 1) / MEMORY_MAP_RESERVE * MEMORY_MAP_RESERVE;
+        if (previousSize > 0 && size < previousSize * 2) {
+            size = previousSize * 2;
+        }
+        void* address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (address == MAP_FAILED) {
+            throw std::runtime_error("Failed to map file: " + filePath);
+        }
+        data = static_cast<char*>(address);
+        mappedSize = size;
+    }
+
+    // ファイルの [offset, end) を含むページに書き込みの印を付ける
+    void markDirty(std::size_t offset, std::size_t end) {
+        dirtyPages.mark(offset / MEMORY_PAGE_SIZE, (end - 1) / MEMORY_PAGE_SIZE);
+    }
+
+    // 印の付いたページを連続した範囲ごとに msync する（ファイルの終端を含むページまで）
+    bool flushPages(const PageBitmap& pages, int flags) {
+        bool succeeded = true;
+        pages.forEachRun((fileSize + MEMORY_PAGE_SIZE - 1) / MEMORY_PAGE_SIZE, [&](std::size_t page, std::size_t count) {
+            if (msync(data + page * MEMORY_PAGE_SIZE, count * MEMORY_PAGE_SIZE, flags) != 0) succeeded = false;
+        });
+        return succeeded;
+    }
+
+    // ファイルの offset から size バイトを読む（ファイルの終端より先は0）
+    void readBytes(std::size_t offset, std::size_t size, void* out) const {
+        std::size_t available = offset < fileSize ? std::min(size, fileSize - offset) : 0;
+        if (available > 0) {
+            std::memcpy(out, data + offset, available);
+        }
+        std::memset(static_cast<char*>(out) + available, 0, size - available);
+    }
+
+    // ファイルの offset から size バイトを書く（ファイルの終端より先なら書いた位置までファイルを伸ばす）
+    void writeBytes(std::size_t offset, std::size_t size, const void* in) {
+        std::size_t end = offset + size;
+        if (end > fileSize) {
+            if (ftruncate(fd, static_cast<off_t>(end)) != 0) {
+                throw std::runtime_error("Failed to create/extend file: " + filePath);
+            }
+            remap();
+        }
+        std::memcpy(data + offset, in, size);
+        markDirty(offset, end);
+    }
+#else
+    void close() {
+        fileSize = 0;
+    }
+
+    // 現在のファイルサイズを調べ直す
+    void remap() {
+        std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+        if (!file) {
+            throw std::runtime_error("Failed to stat file: " + filePath);
+        }
+        fileSize = static_cast<std::size_t>(file.tellg());
+    }
+
+    // ファイルの offset から size バイトを読む（ファイルの終端より先は0）
+    void readBytes(std::size_t offset, std::size_t size, void* out) const {
+        std::size_t available = offset < fileSize ? std::min(size, fileSize - offset) : 0;
+        if (available > 0) {
+            std::ifstream file(filePath, std::ios::binary);
+            if (!file || !file.seekg(static_cast<std::streamoff>(offset)) ||
+                !file.read(static_cast<char*>(out), static_cast<std::streamsize>(available))) {
+                throw std::runtime_error("Failed to open file for reading: " + filePath);
+            }
+        }
+        std::memset(static_cast<char*>(out) + available, 0, size - available);
+    }
+
+    // ファイルの offset から size バイトを書く（終端より先へ移動して書けば、間はゼロで埋まる）
+    void writeBytes(std::size_t offset, std::size_t size, const void* in) {
+        std::fstream file(filePath, std::ios::binary | std::ios::in | std::ios::out);
+        if (!file || !file.seekp(static_cast<std::streamoff>(offset)) ||
+            !file.write(static_cast<const char*>(in), static_cast<std::streamsize>(size)) || !file.flush()) {
+            throw std::runtime_error("Failed to open file for writing: " + filePath);
+        }
+        fileSize = std::max(fileSize, offset + size);
+    }
+#endif
+
+    void checkElement(std::size_t index) const {
+        if (index >= MEMORY_MAP_SIZE) {
+            throw std::out_of_range("Memory map index out of range: " + std::to_string(index));
+        }
+    }
+
+    // 格納形式での読み書き（ファイルの終端より先は0）
+    template <typename Stored>
+    Stored readRaw(std::size_t index) const {
+        checkElement(index);
+        Stored value;
+        readBytes((windowOffset + index) * sizeof(Stored), sizeof(Stored), &value);
+        return value;
+    }
+
+    template <typename Stored>
+    void writeRaw(std::size_t index, Stored value) {
+        checkElement(index);
+        writeBytes((windowOffset + index) * sizeof(Stored), sizeof(Stored), &value);
+    }
+
+public:
+    explicit MemoryMap(char type) : mapType(type) {}
+    ~MemoryMap() { close(); }
+    MemoryMap(const MemoryMap&) = delete;
+    MemoryMap& operator=(const MemoryMap&) = delete;
+
+    bool isMapped() const { return !filePath.empty(); }
+    // ファイル全体の要素数とウィンドウの位置
+    std::size_t elementCount() const { return fileSize / elementSize(); }
+    std::size_t getWindowOffset() const { return windowOffset; }
+
+#ifdef SG_MMAP
+    void mapFile(const std::string& path) {
+        close();
+        filePath = path;
+        windowOffset = 0;
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            filePath.clear();
+            throw std::runtime_error("Failed to create/extend file: " + path);
+        }
+        // ウィンドウ1つ分に満たなければゼロで埋める
+        struct stat status;
+        std::size_t required = MEMORY_MAP_SIZE * elementSize();
+        if (fstat(fd, &status) != 0 ||
+            (static_cast<std::size_t>(status.st_size) < required && ftruncate(fd, static_cast<off_t>(required)) != 0)) {
+            throw std::runtime_error("Failed to create/extend file: " + filePath);
+        }
+        remap();
+    }
+
+    // ファイルが書き換えられたときにマップし直す
+    void reload(const std::string& path) {
+        if (fd < 0 || path != filePath) {
+            return;
+        }
+        if (data) {
+            sync(false);
+            munmap(data, mappedSize);
+            data = nullptr;
+            mappedSize = 0;
+        }
+        remap();
+    }
+
+    // 書き込んだ内容をファイルに反映する（waitなら反映を始めたページも含めてディスクへの書き込みまで待つ）
+    void sync(bool wait) {
+        if (!data || (dirtyPages.empty() && (!wait || flushingPages.empty()))) {
+            return;
+        }
+        flushingPages.merge(dirtyPages);
+        bool succeeded = wait ? flushPages(flushingPages, MS_SYNC) : flushPages(dirtyPages, MS_ASYNC);
+        dirtyPages.clear();
+        if (wait) {
+            flushingPages.clear();
+            if (!succeeded) {
+                throw std::runtime_error("Failed to sync memory map: " + filePath);
+            }
+        }
+    }
+#else
+    void mapFile(const std::string& path) {
+        close();
+        filePath = path;
+        windowOffset = 0;
+        if (!std::ofstream(path, std::ios::binary | std::ios::app)) {
+            filePath.clear();
+            throw std::runtime_error("Failed to create/extend file: " + path);
+        }
+        // ウィンドウ1つ分に満たなければゼロで埋める
+        remap();
+        std::size_t required = MEMORY_MAP_SIZE * elementSize();
+        if (fileSize < required) {
+            std::ofstream file(path, std::ios::binary | std::ios::app);
+            std::vector<char> padding(required - fileSize, 0);
+            if (!file || !file.write(padding.data(), static_cast<std::streamsize>(padding.size()))) {
+                throw std::runtime_error("Failed to create/extend file: " + filePath);
+            }
+            fileSize = required;
+        }
+    }
+
+    // ファイルが書き換えられたときにサイズを調べ直す
+    void reload(const std::string& path) {
+        if (isMapped() && path == filePath) {
+            remap();
+        }
+    }
+
+    // 書き込みは要素ごとにファイルへ流しているので、ここでは何もしない
+    void sync(bool) {}
+#endif
+
+    // 初期化済みか確認
+    MemoryMap& require(const std::string& message) {
+        if (!isMapped()) throw std::runtime_error(message);
+        return *this;
+    }
+
+    int readInt(std::size_t index) const { return static_cast<int>(readRaw<int32_t>(index)); }
+    double readFloat(std::size_t index) const { return static_cast<double>(readRaw<float>(index)); }
+    bool readBool(std::size_t index) const { return static_cast<bool>(readRaw<uint8_t>(index)); }
+    std::string readChar(std::size_t index) const { return std::string(1, readRaw<char>(index)); }
+
+    void write(std::size_t index, int value) { writeRaw<int32_t>(index, value); }
+    void write(std::size_t index, double value) { writeRaw<float>(index, static_cast<float>(value)); }
+    void write(std::size_t index, bool value) { writeRaw<uint8_t>(index, value ? 1 : 0); }
+    void write(std::size_t index, const std::string& value) {
+        // 文字列は1文字ずつ連続配置
+        for (std::size_t i = 0; i < value.size() && (index + i) < MEMORY_MAP_SIZE; ++i) {
+            writeRaw<char>(index + i, value[i]);
+        }
+    }
+
+    // 連続した要素をまとめて読み書き（ファイルの終端より先は0）
+    template <typename Stored>
+    std::vector<Stored> readBlock(std::size_t index, std::size_t count) const {
+        std::vector<Stored> result(count);
+        readBytes((windowOffset + index) * sizeof(Stored), count * sizeof(Stored), result.data());
+        return result;
+    }
+
+    template <typename Stored>
+    void writeBlock(std::size_t index, const Stored* values, std::size_t count) {
+        if (count > 0) {
+            writeBytes((windowOffset + index) * sizeof(Stored), count * sizeof(Stored), values);
+        }
+    }
+
+    // 型の合わない値の書き込み
+    template <typename T>
+    void writeMismatch(std::size_t index, const T&) {
+        checkElement(index);
+        badVariant<void>();
+    }
+
+    // ウィンドウスライド（それまでの書き込みの反映を始め、0未満にならないようにクランプ）
+    void slideWindow(long long offset) {
+        sync(false);
+        std::size_t newOffset;
+        if (offset < 0) {
+            std::size_t back = static_cast<std::size_t>(-(offset + 1)) + 1;
+            newOffset = back < windowOffset ? windowOffset - back : 0;
+        } else {
+            newOffset = windowOffset + static_cast<std::size_t>(offset);
+        }
+        // ウィンドウの終わりまでファイルのオフセットで表せること
+        std::size_t limit = MEMORY_MAP_MAX_OFFSET / elementSize();
+        if (newOffset > limit || MEMORY_MAP_SIZE > limit - newOffset) {
+            throw std::out_of_range("Memory map window offset out of range: " + std::to_string(newOffset));
+        }
+        windowOffset = newOffset;
+    }
+};
+
+MemoryMap intMap('#');
+MemoryMap floatMap('~');
+MemoryMap stringMap('@');
+MemoryMap boolMap('%');
+
+// すべてのメモリマップを同期する（同期文 <<;）
+inline void syncMaps() {
+    for (MemoryMap* map : {&intMap, &floatMap, &stringMap, &boolMap}) {
+        map->sync(true);
+    }
+}
+
+// マップ中のファイルを書き換えたらマップし直す
+inline void reloadMaps(const std::string& path) {
+    for (MemoryMap* map : {&intMap, &floatMap, &stringMap, &boolMap}) {
+        map->reload(path);
+    }
+}
+
+// 標準ライブラリ（$_900〜$_943。十の位が対象、一の位が操作。94xはメモリマップの大きさ）
+template <typename T>
+inline bool nativeLess(T a, T b) {
+    if constexpr (std::is_floating_point_v<T>) {
+        return a < b || (!std::isnan(a) && std::isnan(b));
+    } else {
+        return a < b;
+    }
+}
+
+template <typename T>
+inline bool nativeEqual(T a, T b) {
+    return !nativeLess(a, b) && !nativeLess(b, a);
+}
+
+template <typename T>
+inline std::size_t nativeApply(int operation, T* data, std::size_t count) {
+    using Sum = std::conditional_t<std::is_floating_point_v<T>, double, long long>;
+    auto setResult = [](Sum value) {
+        if constexpr (std::is_floating_point_v<T>) floatPool[RETURN_START] = value;
+        else intPool[RETURN_START] = static_cast<int>(std::clamp<long long>(value, std::numeric_limits<int>::min(), std::numeric_limits<int>::max()));
+    };
+    switch (operation) {
+        case 0: std::sort(data, data + count, nativeLess<T>); break;
+        case 1: std::reverse(data, data + count); break;
+        case 2: {
+            T key;
+            if constexpr (std::is_floating_point_v<T>) key = static_cast<T>(floatPool[ARGS_START + 2]);
+            else key = static_cast<T>(intPool[ARGS_START + 2]);
+            T* found = std::lower_bound(data, data + count, key, nativeLess<T>);
+            intPool[RETURN_START] = (found != data + count && !nativeLess(key, *found)) ? static_cast<int>(found - data) : -1;
+            break;
+        }
+        case 3:
+            count = static_cast<std::size_t>(std::unique(data, data + count, nativeEqual<T>) - data);
+            intPool[RETURN_START] = static_cast<int>(count);
+            break;
+        case 4: case 5: {
+            if (count == 0) throw std::runtime_error(std::string(operation == 4 ? "Min" : "Max") + " of an empty range");
+            T* result = operation == 4 ? std::min_element(data, data + count, nativeLess<T>)
+                                       : std::max_element(data, data + count, nativeLess<T>);
+            setResult(static_cast<Sum>(*result));
+            break;
+        }
+        case 6: {
+            Sum total = 0;
+            for (std::size_t i = 0; i < count; ++i) total += data[i];
+            setResult(total);
+            if constexpr (!std::is_floating_point_v<T>) floatPool[RETURN_START] = static_cast<double>(total);
+            break;
+        }
+    }
+    return count;
+}
+
+template <typename Stored>
+inline void nativeMap(int operation, MemoryMap& map, char type) {
+    map.require(std::string("Memory map not initialized for type: ") + type);
+    int start = intPool[ARGS_START];
+    int count = intPool[ARGS_START + 1];
+    if (start < 0 || count < 0 || count > static_cast<int>(MEMORY_MAP_SIZE) - start) {
+        throw std::out_of_range("Memory map range out of range: " + std::to_string(start) + "+" + std::to_string(count));
+    }
+    std::vector<Stored> data = map.readBlock<Stored>(start, count);
+    std::size_t kept = nativeApply(operation, data.data(), data.size());
+    if (operation <= 1 || operation == 3) map.writeBlock(start, data.data(), kept);
+}
+
+// メモリマップのファイル全体の要素数とウィンドウの位置（$#はintの上限で頭打ち）
+inline void nativeMapInfo(MemoryMap& map, char type) {
+    map.require(std::string("Memory map not initialized for type: ") + type);
+    std::size_t values[] = {map.elementCount(), map.getWindowOffset()};
+    for (std::size_t i = 0; i < 2; ++i) {
+        intPool[RETURN_START + i] = static_cast<int>(std::min<std::size_t>(values[i], std::numeric_limits<int>::max()));
+        floatPool[RETURN_START + i] = static_cast<double>(values[i]);
+    }
+}
+
+inline void native(int id) {
+    int operation = id % 10;
+    if (id / 10 == 94) {
+        MemoryMap* maps[] = {&intMap, &floatMap, &stringMap, &boolMap};
+        nativeMapInfo(*maps[operation], "#~@%"[operation]);
+        return;
+    }
+    switch (id / 10) {
+        case 90: intStack.resize(nativeApply(operation, intStack.data(), intStack.size())); break;
+        case 91: floatStack.resize(nativeApply(operation, floatStack.data(), floatStack.size())); break;
+        case 92: nativeMap<int32_t>(operation, intMap, '#'); break;
+        case 93: nativeMap<float>(operation, floatMap, '~'); break;
+    }
+}
+
+// 関数呼び出し
+inline void call(int id, const char* name) {
+    if (!functions[id]) {
+        throw std::runtime_error(std::string("Function not found: ") + name);
+    }
+    functions[id]();
+}
+
+// 入力（標準入力が端末のときだけ入力を促す。端末か調べられない環境では促さない）
+inline bool promptInput() {
+#if defined(__unix__) || defined(__APPLE__)
+    static const bool terminal = isatty(STDIN_FILENO);
+#else
+    static const bool terminal = false;
+#endif
+    return terminal;
+}
+
+inline std::string input(const char* name) {
+    std::string value;
+    if (promptInput()) {
+        std::cout << "Input " << name << ": ";
+        std::cout.flush();
+        std::cin >> value;
+        return value;
+    }
+    if (!(std::cin >> value)) {
+        throw std::runtime_error(std::string("Unexpected end of input for ") + name);
+    }
+    // 語の後ろが行末まで空白なら改行も読み飛ばす
+    while (std::cin.peek() == ' ' || std::cin.peek() == '\t' || std::cin.peek() == '\r') {
+        std::cin.get();
+    }
+    if (std::cin.peek() == '\n') {
+        std::cin.get();
+    }
+    return value;
+}
+
+// 文字列の入力（端末でなければ1行を読む）
+inline std::string inputLine(const char* name) {
+    if (promptInput()) {
+        return input(name);
+    }
+    std::string value;
+    if (!std::getline(std::cin, value)) {
+        throw std::runtime_error(std::string("Unexpected end of input for ") + name);
+    }
+    if (!value.empty() && value.back() == '\r') {
+        value.pop_back();
+    }
+    return value;
+}
+
+inline bool parseBool(const std::string& value) {
+    return value == "true" || value == "1";
+}
+
+// ファイル入出力
+inline std::string readFile(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file) {
+        throw std::runtime_error("Failed to open file: " + filename);
+    }
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+inline void writeFile(const std::string& filename, const std::string& content) {
+    std::ofstream file(filename);
+    if (!file) {
+        throw std::runtime_error("Failed to open file: " + filename);
+    }
+    file << content;
+    file.close();
+    reloadMaps(filename);
+}
+
+} // namespace sg
+)SIGNUM";
@@ -0,0 +1,964 @@
+// SigNum C++ Transpiler
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include "transpiler.hpp"
+#include "../interpreter/interpreter.hpp"
+#include "../native/native.hpp"
+#include "../version.hpp"
+
+// 1行出力
+static void line(std::string& out, int depth, const std::string& text) {
+    out += std::string(depth * 4, ' ') + text + "\n";
+}
+
+// C++の文字列リテラル
+static std::string quote(const std::string& text) {
+    std::string result = "\"";
+    for (unsigned char c : text) {
+        switch (c) {
+            case '"': result += "\\\""; break;
+            case '\\': result += "\\\\"; break;
+            case '\n': result += "\\n"; break;
+            case '\r': result += "\\r"; break;
+            case '\t': result += "\\t"; break;
+            default:
+                if (c < 0x20 || c >= 0x7f) {
+                    char escaped[5];
+                    std::snprintf(escaped, sizeof(escaped), "\\%03o", c);
+                    result += escaped;
+                } else {
+                    result += static_cast<char>(c);
+                }
+                break;
+        }
+    }
+    return result + "\"";
+}
+
+// 実行時に例外を投げる文
+static std::string throwStatement(const std::string& message) {
+    return "throw std::runtime_error(" + quote(message) + ");";
+}
+
+// 整数として扱える型か（boolは0/1）
+static bool isIntegral(char type) {
+    return type == '#' || type == '%';
+}
+
+// 数値型か
+static bool isNumber(char type) {
+    return type == '#' || type == '~';
+}
+
+// C++の演算子
+static const char* operatorSymbol(Operator op) {
+    switch (op) {
+        case Operator::Add: return "+";
+        case Operator::Subtract: return "-";
+        case Operator::Multiply: return "*";
+        case Operator::Equal: return "==";
+        case Operator::NotEqual: return "!=";
+        case Operator::Less: return "<";
+        case Operator::LessEqual: return "<=";
+        case Operator::Greater: return ">";
+        case Operator::GreaterEqual: return ">=";
+        default: return nullptr;
+    }
+}
+
+// プログラム全体をC++のソースに変換
+std::string CppTranspiler::transpile(const std::shared_ptr<ASTNode>& program) {
+    functionDefinitions.clear();
+    stringConstants.clear();
+    stringNames.clear();
+    functionVersions.clear();
+    tempCount = 0;
+
+    std::string body;
+    emitStatement(program, body, 1);
+
+    std::string out;
+    out += "// Generated by SigNum " + SigNum::getShortVersionString() + " (--emit-cpp)\n";
+    if (mapWindowSize > 0) {
+        out += "#define SG_MAP_WINDOW " + std::to_string(mapWindowSize) + "\n";
+    }
+    out += CPP_RUNTIME;
+    out += "\n";
+    for (const auto& definition : stringConstants) {
+        out += definition;
+    }
+    if (!stringConstants.empty()) {
+        out += "\n";
+    }
+    for (const auto& definition : functionDefinitions) {
+        out += definition + "\n";
+    }
+    out += "static void program() {\n" + body + "}\n\n";
+    out += "int main() {\n";
+    out += "    std::ios::sync_with_stdio(false);\n";
+    out += "    std::cin.tie(nullptr);\n";
+    out += "    try {\n";
+    out += "        program();\n";
+    out += "    }\n";
+    out += "    catch (const std::exception& e) {\n";
+    out += "        std::cout.flush();\n";
+    out += "        std::cerr << \"Error: \" << e.what() << std::endl;\n";
+    out += "        return 1;\n";
+    out += "    }\n";
+    out += "    return 0;\n";
+    out += "}\n";
+    return out;
+}
+
+// 文の生成
+void CppTranspiler::emitStatement(const std::shared_ptr<ASTNode>& node, std::string& out, int depth) {
+    switch (node->type) {
+        case NodeType::Program:
+        case NodeType::Statement:
+            for (const auto& child : node->children) {
+                emitStatement(child, out, depth);
+            }
+            return;
+
+        case NodeType::Function:
+            emitFunction(node, out, depth);
+            return;
+
+        case NodeType::FunctionCall: {
+            int id = std::stoi(node->value);
+            // 標準ライブラリはランタイムに同じものがある（ホストが登録したネイティブ関数は呼べない）
+            if (isStandardFunction(id)) {
+                line(out, depth, "sg::native(" + std::to_string(id) + ");");
+            } else {
+                line(out, depth, "sg::call(" + std::to_string(id) + ", " + quote(node->value) + ");");
+            }
+            return;
+        }
+
+        case NodeType::Assignment:
+            emitAssignment(node, out, depth);
+            return;
+
+        case NodeType::IfStatement:
+            emitIfStatement(node, out, depth);
+            return;
+
+        case NodeType::LoopStatement:
+            emitLoopStatement(node, out, depth);
+            return;
+
+        case NodeType::OutputStatement:
+            if (node->children.empty()) {
+                line(out, depth, "sg::flush();");
+            } else {
+                line(out, depth, "sg::print(" + emitExpression(node->children[0]).code + ");");
+            }
+            return;
+
+        case NodeType::InputStatement:
+            emitInput(node, out, depth);
+            return;
+
+        case NodeType::FileInputStatement:
+            emitFileInput(node, out, depth);
+            return;
+
+        case NodeType::FileOutputStatement:
+            emitFileOutput(node, out, depth);
+            return;
+
+        case NodeType::MapWindowSlide:
+            emitWindowSlide(node, out, depth);
+            return;
+
+        case NodeType::Error:
+            line(out, depth, throwStatement("Parse error encountered: " + node->value));
+            return;
+
+        // 式文
+        default:
+            line(out, depth, "(void)(" + emitExpression(node).code + ");");
+            return;
+    }
+}
+
+// 関数定義の生成（定義文の実行時に関数テーブルへ登録する）
+void CppTranspiler::emitFunction(const std::shared_ptr<ASTNode>& node, std::string& out, int depth) {
+    int version = functionVersions[node->value]++;
+    std::string name = "function_" + node->value;
+    if (version > 0) {
+        name += "_" + std::to_string(version);
+    }
+
+    std::string body;
+    for (const auto& child : node->children) {
+        emitStatement(child, body, 1);
+    }
+    functionDefinitions.push_back("static void " + name + "() {\n" + body + "}\n");
+
+    line(out, depth, "sg::functions[" + std::to_string(std::stoi(node->value)) + "] = &" + name + ";");
+}
+
+// 代入の生成
+void CppTranspiler::emitAssignment(const std::shared_ptr<ASTNode>& node, std::string& out, int depth) {
+    const auto& target = node->children[0];
+    const auto& source = node->children[1];
+
+    // 複合代入（右辺は 左辺 op 式 の形）
+    if (node->op != Operator::None && source->type == NodeType::ArithmeticExpression &&
+        source->children.size() == 2) {
+        emitCompoundAssignment(node, out, depth);
+        return;
+    }
+
+    Expr value = emitExpression(source);
+    if (!target->memory.valid) {
+        line(out, depth, "(void)(" + value.code + ");");
+        line(out, depth, throwStatement("Invalid assignment target: " + target->value));
+        return;
+    }
+    emitStore(target->memory, value, out, depth);
+}
+
+// 値をメモリ参照に格納する
+void CppTranspiler::emitStore(const MemoryDescriptor& mem, const Expr& value, std::string& out, int depth) {
+    if (mem.isMap) {
+        // 値、インデックスの順に評価してから書き込む
+        std::string temp = newTemp();
+        std::string index = newTemp();
+        std::string map = mapObject(mem.type) + ".require(" +
+                          quote("Memory map not initialized for assignment: $^" + std::string(1, mem.type)) + ")";
+        line(out, depth, "{");
+        line(out, depth + 1, cppType(value.type) + " " + temp + " = " + value.code + ";");
+        line(out, depth + 1, "std::size_t " + index + " = static_cast<std::size_t>(" + indexCode(mem, false) + ");");
+        if (value.type == mem.type) {
+            line(out, depth + 1, map + ".write(" + index + ", " + temp + ");");
+        } else {
+            line(out, depth + 1, map + ".writeMismatch(" + index + ", " + temp + ");");
+        }
+        line(out, depth, "}");
+        return;
+    }
+
+    if (value.type == mem.type) {
+        line(out, depth, poolElement(mem.type, indexCode(mem, true)) + " = " + value.code + ";");
+        return;
+    }
+
+    // 型が合わなければ実行時エラー
+    std::string temp = newTemp();
+    line(out, depth, "{");
+    line(out, depth + 1, cppType(value.type) + " " + temp + " = " + value.code + ";");
+    line(out, depth + 1, "sg::typeMismatch(" + temp + ", '" + std::string(1, mem.type) + "', " +
+                         indexCode(mem, true) + ");");
+    line(out, depth, "}");
+}
+
+// 複合代入の生成（対象を1度だけ解決してその場で更新する）
+void CppTranspiler::emitCompoundAssignment(const std::shared_ptr<ASTNode>& node, std::string& out, int depth) {
+    const MemoryDescriptor& mem = node->children[0]->memory;
+    Operator op = node->op;
+    Expr operand = emitExpression(node->children[1]->children[1]);
+
+    if (!mem.valid) {
+        line(out, depth, "(void)(" + operand.code + ");");
+        line(out, depth, throwStatement("Invalid assignment target: " + node->children[0]->value));
+        return;
+    }
+
+    // その場で更新できる組み合わせ
+    bool inPlace = (mem.type == '#' && operand.type == '#' && op >= Operator::Add && op <= Operator::Modulus) ||
+                   (mem.type == '~' && operand.type == '~' && op >= Operator::Add && op <= Operator::Divide) ||
+                   (mem.type == '@' && op == Operator::Add);
+
+    auto update = [&](const std::string& element, const std::string& value) {
+        switch (op) {
+            case Operator::Divide:
+                return element + " = " + (mem.type == '#' ? "sg::idiv(" : "sg::fdiv(") + element + ", " + value + ");";
+            case Operator::Modulus:
+                return element + " = sg::imod(" + element + ", " + value + ");";
+            default:
+                if (mem.type == '@') {
+                    return element + " += sg::str(" + value + ");";
+                }
+                return element + " " + operatorSymbol(op) + "= " + value + ";";
+        }
+    };
+
+    // 添字が静的で右辺に副作用がなければ1文で更新する
+    bool staticIndex = mem.indirection.empty() && mem.index >= 0 && mem.index < static_cast<int>(MEMORY_POOL_SIZE);
+    if (!mem.isMap && inPlace && staticIndex && operand.pure) {
+        line(out, depth, update(poolElement(mem.type, std::to_string(mem.index)), operand.code));
+        return;
+    }
+
+    std::string value = newTemp();
+    std::string index = newTemp();
+    line(out, depth, "{");
+    line(out, depth + 1, cppType(operand.type) + " " + value + " = " + operand.code + ";");
+
+    if (mem.isMap) {
+        std::string map = mapObject(mem.type);
+        std::string read;
+        switch (mem.type) {
+            case '#': read = "readInt"; break;
+            case '~': read = "readFloat"; break;
+            case '%': read = "readBool"; break;
+            default: read = "readChar"; break;
+        }
+        line(out, depth + 1, "std::size_t " + index + " = static_cast<std::size_t>(" + indexCode(mem, false) + ");");
+        Expr current{map + ".require(" + quote("Memory map not initialized for type: " + std::string(1, mem.type)) +
+                     ")." + read + "(" + index + ")", mem.type, true};
+        Expr result = emitArithmetic(op, current, Expr{value, operand.type, true});
+        std::string writer = mapObject(mem.type) + ".require(" +
+                             quote("Memory map not initialized for assignment: $^" + std::string(1, mem.type)) + ")";
+        if (result.type == mem.type) {
+            line(out, depth + 1, writer + ".write(" + index + ", " + result.code + ");");
+        } else {
+            std::string temp = newTemp();
+            line(out, depth + 1, cppType(result.type) + " " + temp + " = " + result.code + ";");
+            line(out, depth + 1, writer + ".writeMismatch(" + index + ", " + temp + ");");
+        }
+        line(out, depth, "}");
+        return;
+    }
+
+    line(out, depth + 1, "int " + index + " = " + indexCode(mem, true) + ";");
+    std::string element = poolElement(mem.type, index);
+    if (inPlace) {
+        line(out, depth + 1, update(element, value));
+    } else {
+        // それ以外は汎用の演算で計算して書き戻す
+        Expr result = emitArithmetic(op, Expr{element, mem.type, true}, Expr{value, operand.type, true});
+        if (result.type == mem.type) {
+            line(out, depth + 1, element + " = " + result.code + ";");
+        } else {
+            std::string temp = newTemp();
+            line(out, depth + 1, cppType(result.type) + " " + temp + " = " + result.code + ";");
+            line(out, depth + 1, "sg::typeMismatch(" + temp + ", '" + std::string(1, mem.type) + "', " + index + ");");
+        }
+    }
+    line(out, depth, "}");
+}
+
+// 条件分岐の生成（trueのときだけ本体に入る）
+void CppTranspiler::emitIfStatement(const std::shared_ptr<ASTNode>& node, std::string& out, int depth) {
+    const auto& children = node->children;
+    auto condition = [&](const std::shared_ptr<ASTNode>& child) {
+        Expr value = emitExpression(child);
+        if (value.type == '%') {
+            return value.code;
+        }
+        return "((void)(" + value.code + "), false)";
+    };
+
+    line(out, depth, "if (" + condition(children[0]) + ") {");
+    emitStatement(children[1], out, depth + 1);
+    // 2つ置きに条件と本体、最後の1つはelse
+    for (size_t i = 2; i < children.size(); i += 2) {
+        if (i == children.size() - 1) {
+            line(out, depth, "} else {");
+            emitStatement(children[i], out, depth + 1);
+            break;
+        }
+        line(out, depth, "} else if (" + condition(children[i]) + ") {");
+        emitStatement(children[i + 1], out, depth + 1);
+    }
+    line(out, depth, "}");
+}
+
+// ループの生成（falseのときだけ抜ける）
+void CppTranspiler::emitLoopStatement(const std::shared_ptr<ASTNode>& node, std::string& out, int depth) {
+    Expr condition = emitExpression(node->children[0]);
+    std::string code = condition.code;
+    if (condition.type != '%') {
+        code = "((void)(" + code + "), true)";
+    }
+    line(out, depth, "while (" + code + ") {");
+    emitStatement(node->children[1], out, depth + 1);
+    line(out, depth, "}");
+}
+
+// 入力文の生成
+void CppTranspiler::emitInput(const std::shared_ptr<ASTNode>& node, std::string& out, int depth) {
+    const std::string& varName = node->children[0]->value;
+    const MemoryDescriptor& mem = node->children[0]->memory;
+    if (!mem.valid || mem.isMap) {
+        line(out, depth, throwStatement("Invalid memory reference for input: " + varName));
+        return;
+    }
+
+    std::string input = "sg::input(" + quote(varName) + ")";
+    std::string value;
+    switch (mem.type) {
+        case '#': value = "std::stoi(" + input + ")"; break;
+        case '~': value = "std::stod(" + input + ")"; break;
+        case '%': value = "sg::parseBool(" + input + ")"; break;
+        case '@': value = "sg::inputLine(" + quote(varName) + ")"; break;
+        default:
+            line(out, depth, "(void)" + input + ";");
+            line(out, depth, throwStatement("Unknown memory type for input: " + std::string(1, mem.type)));
+            return;
+    }
+    line(out, depth, poolElement(mem.type, indexCode(mem, true)) + " = " + value + ";");
+}
+
+// ファイル入力文の生成
+void CppTranspiler::emitFileInput(const std::shared_ptr<ASTNode>& node, std::string& out, int depth) {
+    Expr filename = emitExpression(node->children[0]);
+    const MemoryDescriptor& mem = node->children[1]->memory;
+
+    line(out, depth, "{");
+    if (filename.type != '@') {
+        line(out, depth + 1, "(void)(" + filename.code + ");");
+        line(out, depth + 1, "sg::badVariant<void>();");
+        line(out, depth, "}");
+        return;
+    }
+    std::string name = newTemp();
+    line(out, depth + 1, "std::string " + name + " = " + filename.code + ";");
+
+    if (!mem.valid) {
+        line(out, depth + 1, throwStatement("Invalid memory reference for file input: " + node->children[1]->value));
+    }
+    // メモリマップにファイルをマッピング
+    else if (mem.isMap) {
+        line(out, depth + 1, mapObject(mem.type) + ".mapFile(" + name + ");");
+    }
+    // 通常のメモリ参照への読み込み
+    else if (mem.type == '@') {
+        line(out, depth + 1, poolElement(mem.type, indexCode(mem, true)) + " = sg::readFile(" + name + ");");
+    }
+    else {
+        std::string content = newTemp();
+        line(out, depth + 1, "std::string " + content + " = sg::readFile(" + name + ");");
+        line(out, depth + 1, "sg::typeMismatch(" + content + ", '" + std::string(1, mem.type) + "', " +
+                             indexCode(mem, true) + ");");
+    }
+    line(out, depth, "}");
+}
+
+// ファイル出力文の生成
+void CppTranspiler::emitFileOutput(const std::shared_ptr<ASTNode>& node, std::string& out, int depth) {
+    // 同期文 "<<;"
+    if (node->children.empty()) {
+        line(out, depth, "sg::syncMaps();");
+        return;
+    }
+    Expr filename = emitExpression(node->children[0]);
+    const MemoryDescriptor& mem = node->children[1]->memory;
+
+    line(out, depth, "{");
+    if (filename.type != '@') {
+        line(out, depth + 1, "(void)(" + filename.code + ");");
+        line(out, depth + 1, "sg::badVariant<void>();");
+        line(out, depth, "}");
+        return;
+    }
+    std::string name = newTemp();
+    line(out, depth + 1, "std::string " + name + " = " + filename.code + ";");
+
+    // メモリマップは書き込み済みなので、ディスクへの反映を待つ
+    if (mem.valid && mem.isMap) {
+        line(out, depth + 1, mapObject(mem.type) + ".require(" + quote("Memory map not initialized for output") + ").sync(true);");
+    }
+    // 通常のメモリ参照からファイルへの出力
+    else {
+        Expr value = emitExpression(node->children[1]);
+        line(out, depth + 1, "sg::writeFile(" + name + ", sg::str(" + value.code + "));");
+    }
+    line(out, depth, "}");
+}
+
+// ウィンドウスライドの生成
+void CppTranspiler::emitWindowSlide(const std::shared_ptr<ASTNode>& node, std::string& out, int depth) {
+    if (node->children.size() < 2) {
+        line(out, depth, throwStatement("Map window slide missing arguments"));
+        return;
+    }
+
+    Expr amount = emitExpression(node->children[0]);
+    const MemoryDescriptor& mem = node->children[1]->memory;
+
+    line(out, depth, "{");
+    if (amount.type != '#') {
+        line(out, depth + 1, "(void)(" + amount.code + ");");
+        line(out, depth + 1, "sg::badVariant<void>();");
+        line(out, depth, "}");
+        return;
+    }
+    std::string temp = newTemp();
+    line(out, depth + 1, "int " + temp + " = " + amount.code + ";");
+    if (!mem.valid || !mem.isMap) {
+        line(out, depth + 1, throwStatement("Invalid memory reference in slide: " + node->children[1]->value));
+    } else {
+        line(out, depth + 1, mapObject(mem.type) + ".require(" +
+                             quote("Memory map not initialized for slide operation") + ").slideWindow(" + temp + ");");
+    }
+    line(out, depth, "}");
+}
+
+// 式の生成
+CppTranspiler::Expr CppTranspiler::emitExpression(const std::shared_ptr<ASTNode>& node) {
+    switch (node->type) {
+        case NodeType::Number:
+        case NodeType::String:
+        case NodeType::Constant:
+            return emitConstant(node);
+
+        case NodeType::MemoryRef: {
+            const MemoryDescriptor& mem = node->memory;
+            if (!mem.valid || mem.isMap) {
+                return Expr{"sg::fail<int>(" + quote("Invalid memory reference: " + node->value) + ")", '#', true};
+            }
+            return Expr{poolElement(mem.type, indexCode(mem, true)), mem.type, true};
+        }
+
+        case NodeType::MemoryMapRef: {
+            const MemoryDescriptor& mem = node->memory;
+            if (!mem.valid || !mem.isMap) {
+                return Expr{"sg::fail<int>(" + quote("Invalid memory map reference: " + node->value) + ")", '#', true};
+            }
+            std::string read;
+            switch (mem.type) {
+                case '#': read = "readInt"; break;
+                case '~': read = "readFloat"; break;
+                case '%': read = "readBool"; break;
+                default: read = "readChar"; break;
+            }
+            // インデックスを解決してから初期化を確認する
+            std::string temp = newTemp();
+            return Expr{"[&]() -> " + cppType(mem.type) + " { std::size_t " + temp + " = static_cast<std::size_t>(" +
+                        indexCode(mem, false) + "); return " + mapObject(mem.type) + ".require(" +
+                        quote("Memory map not initialized for type: " + std::string(1, mem.type)) + ")." +
+                        read + "(" + temp + "); }()",
+                        mem.type, true};
+        }
+
+        case NodeType::ArithmeticExpression:
+            if (node->children.size() == 1) {
+                return emitExpression(node->children[0]);
+            }
+            if (node->children.size() == 2) {
+                return emitArithmetic(node->op, emitExpression(node->children[0]), emitExpression(node->children[1]));
+            }
+            return Expr{"sg::fail<int>(" + quote("Invalid arithmetic expression: " + node->toJSON()) + ")", '#', true};
+
+        case NodeType::Comparison:
+            return emitComparison(node->op, emitExpression(node->children[0]), emitExpression(node->children[1]));
+
+        case NodeType::LogicalExpression:
+            return emitLogical(node);
+
+        case NodeType::Cast:
+            return emitCast(node->op, emitExpression(node->children[0]));
+
+        case NodeType::CharCodeCast:
+            return emitCharCodeCast(node->op, emitExpression(node->children[0]));
+
+        case NodeType::StringIndex:
+            return emitStringIndex(node);
+
+        case NodeType::StringLength: {
+            if (node->children.empty()) {
+                return Expr{"sg::fail<int>(" + quote("String length requires an expression") + ")", '#', true};
+            }
+            Expr operand = emitExpression(node->children[0]);
+            if (operand.type != '@') {
+                return failAfter(operand, '#', "String length can only be used on string type");
+            }
+            return Expr{"static_cast<int>(" + operand.code + ".length())", '#', operand.pure};
+        }
+
+        case NodeType::StackOperation:
+            return emitStackOperation(node);
+
+        // 文は式として評価すると何も返さない
+        case NodeType::Program:
+        case NodeType::Function:
+        case NodeType::FunctionCall:
+        case NodeType::Statement:
+        case NodeType::Assignment:
+        case NodeType::IfStatement:
+        case NodeType::LoopStatement:
+        case NodeType::InputStatement:
+        case NodeType::OutputStatement:
+        case NodeType::FileInputStatement:
+        case NodeType::FileOutputStatement:
+        case NodeType::MapWindowSlide:
+        case NodeType::Error:
+            return emitStatementExpression(node);
+
+        default:
+            return Expr{"sg::fail<int>(" + quote("Unknown node type: " + std::to_string(static_cast<int>(node->type))) + ")",
+                        '#', true};
+    }
+}
+
+// 定数の生成
+CppTranspiler::Expr CppTranspiler::emitConstant(const std::shared_ptr<ASTNode>& node) {
+    if (!node->constant) {
+        // 構文解析時に値にできなかったリテラル（実行時に同じ例外を投げる）
+        if (node->type == NodeType::String) {
+            return Expr{stringConstant(node->value), '@', true};
+        }
+        return Expr{"std::stoi(std::string(" + quote(node->value) + "))", '#', true};
+    }
+
+    const Value& value = *node->constant;
+    if (const int* number = std::get_if<int>(&value)) {
+        if (*number == INT32_MIN) {
+            return Expr{"(-2147483647 - 1)", '#', true};
+        }
+        std::string code = std::to_string(*number);
+        return Expr{*number < 0 ? "(" + code + ")" : code, '#', true};
+    }
+    if (const double* number = std::get_if<double>(&value)) {
+        std::string code;
+        if (std::isnan(*number)) {
+            code = "std::numeric_limits<double>::quiet_NaN()";
+        } else if (std::isinf(*number)) {
+            code = "std::numeric_limits<double>::infinity()";
+            if (*number < 0) code = "(-" + code + ")";
+        } else {
+            char buffer[32];
+            std::snprintf(buffer, sizeof(buffer), "%.17g", *number);
+            code = buffer;
+            if (code.find_first_of(".e") == std::string::npos) {
+                code += ".0";
+            }
+            if (*number < 0) code = "(" + code + ")";
+        }
+        return Expr{code, '~', true};
+    }
+    if (const bool* flag = std::get_if<bool>(&value)) {
+        return Expr{*flag ? "true" : "false", '%', true};
+    }
+    return Expr{stringConstant(std::get<std::string>(value)), '@', true};
+}
+
+// 算術演算の生成
+CppTranspiler::Expr CppTranspiler::emitArithmetic(Operator op, const Expr& left, const Expr& right) {
+    // int/bool同士
+    if (isIntegral(left.type) && isIntegral(right.type)) {
+        switch (op) {
+            case Operator::Divide:
+                return sequence(left, right, '#', [](const std::string& l, const std::string& r) {
+                    return "sg::idiv(" + l + ", " + r + ")";
+                });
+            case Operator::Modulus:
+                return sequence(left, right, '#', [](const std::string& l, const std::string& r) {
+                    return "sg::imod(" + l + ", " + r + ")";
+                });
+            default:
+                if (const char* symbol = operatorSymbol(op)) {
+                    return sequence(left, right, '#', [symbol](const std::string& l, const std::string& r) {
+                        return "(" + l + " " + symbol + " " + r + ")";
+                    });
+                }
+                break;
+        }
+    }
+    // doubleを含む数値
+    else if (left.type != '@' && right.type != '@') {
+        switch (op) {
+            case Operator::Add:
+            case Operator::Subtract:
+            case Operator::Multiply: {
+                const char* symbol = operatorSymbol(op);
+                return sequence(left, right, '~', [symbol](const std::string& l, const std::string& r) {
+                    return "(static_cast<double>(" + l + ") " + symbol + " " + r + ")";
+                });
+            }
+            case Operator::Divide:
+                return sequence(left, right, '~', [](const std::string& l, const std::string& r) {
+                    return "sg::fdiv(" + l + ", " + r + ")";
+                });
+            default:
+                break;
+        }
+    }
+    // str-任意の型
+    else if (op == Operator::Add) {
+        return sequence(left, right, '@', [](const std::string& l, const std::string& r) {
+            return "(sg::str(" + l + ") + sg::str(" + r + "))";
+        });
+    }
+
+    std::string symbol = operator2String(op);
+    return sequence(left, right, '#', [symbol](const std::string& l, const std::string& r) {
+        return "sg::fail<int>(\"Invalid arithmetic expression: \" + sg::str(" + l + ") + " +
+               quote(" " + symbol + " ") + " + sg::str(" + r + "))";
+    });
+}
+
+// 比較演算の生成
+CppTranspiler::Expr CppTranspiler::emitComparison(Operator op, const Expr& left, const Expr& right) {
+    const char* symbol = operatorSymbol(op);
+    bool equality = op == Operator::Equal || op == Operator::NotEqual;
+
+    if (symbol && op >= Operator::Equal) {
+        // 数値同士（intとdoubleはdoubleで比較）、または同じ型同士の等値比較
+        if ((isNumber(left.type) && isNumber(right.type)) || (equality && left.type == right.type)) {
+            return sequence(left, right, '%', [symbol](const std::string& l, const std::string& r) {
+                return "(" + l + " " + symbol + " " + r + ")";
+            });
+        }
+        // 型が異なる場合は文字列として比較
+        if (equality) {
+            return sequence(left, right, '%', [symbol](const std::string& l, const std::string& r) {
+                return "(sg::str(" + l + ") " + symbol + " sg::str(" + r + "))";
+            });
+        }
+    }
+
+    std::string name = operator2String(op);
+    return sequence(left, right, '%', [name](const std::string& l, const std::string& r) {
+        return "sg::fail<bool>(\"Invalid comparison: \" + sg::str(" + l + ") + " +
+               quote(" " + name + " ") + " + sg::str(" + r + "))";
+    });
+}
+
+// 論理演算の生成
+CppTranspiler::Expr CppTranspiler::emitLogical(const std::shared_ptr<ASTNode>& node) {
+    std::string message = "Invalid logical expression: " + node->toJSON();
+
+    if (node->children.size() == 1) {
+        Expr operand = emitExpression(node->children[0]);
+        if (node->op != Operator::Not) {
+            return operand;
+        }
+        if (operand.type != '%') {
+            return failAfter(operand, '%', "Invalid logical negation: " + node->toJSON());
+        }
+        return Expr{"(!" + operand.code + ")", '%', operand.pure};
+    }
+    if (node->children.size() != 2) {
+        return Expr{"sg::fail<bool>(" + quote(message) + ")", '%', true};
+    }
+
+    Expr left = emitExpression(node->children[0]);
+    Expr right = emitExpression(node->children[1]);
+    if (left.type == '%' && right.type == '%' && (node->op == Operator::And || node->op == Operator::Or)) {
+        // ツリーウォーカーと同じく両辺とも評価する
+        std::string function = node->op == Operator::And ? "sg::both(" : "sg::either(";
+        return sequence(left, right, '%', [function](const std::string& l, const std::string& r) {
+            return function + l + ", " + r + ")";
+        });
+    }
+    return sequence(left, right, '%', [message](const std::string& l, const std::string& r) {
+        return "((void)(" + l + "), (void)(" + r + "), sg::fail<bool>(" + quote(message) + "))";
+    });
+}
+
+// 型変換の生成
+CppTranspiler::Expr CppTranspiler::emitCast(Operator op, const Expr& operand) {
+    switch (op) {
+        case Operator::IntCast:
+            if (operand.type == '~') return Expr{"static_cast<int>(" + operand.code + ")", '#', operand.pure};
+            if (operand.type == '@') return Expr{"std::stoi(" + operand.code + ")", '#', operand.pure};
+            break;
+        case Operator::FloatCast:
+            if (operand.type == '#') return Expr{"static_cast<double>(" + operand.code + ")", '~', operand.pure};
+            if (operand.type == '@') return Expr{"std::stod(" + operand.code + ")", '~', operand.pure};
+            break;
+        case Operator::StringCast:
+            return Expr{"std::string(sg::str(" + operand.code + "))", '@', operand.pure};
+        case Operator::BoolCast:
+            if (operand.type == '#') return Expr{"(" + operand.code + " != 0)", '%', operand.pure};
+            if (operand.type == '~') return Expr{"(" + operand.code + " != 0.0)", '%', operand.pure};
+            if (operand.type == '@') return Expr{"(!" + operand.code + ".empty())", '%', operand.pure};
+            break;
+        default:
+            break;
+    }
+    return Expr{"sg::fail<int>(" + quote("Invalid cast: " + operator2String(op) + " from ") +
+                " + sg::str(" + operand.code + "))",
+                '#', operand.pure};
+}
+
+// 文字コード変換の生成
+CppTranspiler::Expr CppTranspiler::emitCharCodeCast(Operator op, const Expr& operand) {
+    if (op == Operator::CharToInt) {
+        if (operand.type == '@') {
+            return Expr{"sg::charToInt(" + operand.code + ")", '#', operand.pure};
+        }
+        return failAfter(operand, '#', "Character code cast (charToInt) requires string type");
+    }
+    if (op == Operator::IntToChar) {
+        if (operand.type == '#') {
+            return Expr{"sg::intToChar(" + operand.code + ")", '@', operand.pure};
+        }
+        return failAfter(operand, '@', "Character code cast (intToChar) requires int type");
+    }
+    return failAfter(operand, '#', "Invalid character code cast: " + operator2String(op));
+}
+
+// インデックスアクセスの生成
+CppTranspiler::Expr CppTranspiler::emitStringIndex(const std::shared_ptr<ASTNode>& node) {
+    if (node->children.size() < 2) {
+        return Expr{"sg::fail<std::string>(" + quote("String index requires memory reference and index") + ")",
+                    '@', true};
+    }
+
+    Expr str = emitExpression(node->children[0]);
+    Expr index = emitExpression(node->children[1]);
+    std::string message;
+    if (str.type != '@') {
+        message = "String index can only be used on string type";
+    } else if (index.type != '#') {
+        message = "String index must be integer type";
+    }
+    if (!message.empty()) {
+        return sequence(str, index, '@', [message](const std::string& l, const std::string& r) {
+            return "((void)(" + l + "), (void)(" + r + "), sg::fail<std::string>(" + quote(message) + "))";
+        });
+    }
+    return sequence(str, index, '@', [](const std::string& l, const std::string& r) {
+        return "sg::charAt(" + l + ", " + r + ")";
+    });
+}
+
+// スタック操作の生成（プッシュは何も返さない＝int 0）
+CppTranspiler::Expr CppTranspiler::emitStackOperation(const std::shared_ptr<ASTNode>& node) {
+    char type = '\0';
+    bool push = false;
+    const char* name = "";
+    switch (node->op) {
+        case Operator::IntegerStackPush: type = '#'; push = true; name = "Integer"; break;
+        case Operator::IntegerStackPop: type = '#'; name = "Integer"; break;
+        case Operator::FloatStackPush: type = '~'; push = true; name = "Float"; break;
+        case Operator::FloatStackPop: type = '~'; name = "Float"; break;
+        case Operator::StringStackPush: type = '@'; push = true; name = "String"; break;
+        case Operator::StringStackPop: type = '@'; name = "String"; break;
+        case Operator::BooleanStackPush: type = '%'; push = true; name = "Boolean"; break;
+        case Operator::BooleanStackPop: type = '%'; name = "Boolean"; break;
+        default: break;
+    }
+
+    Expr operand = emitExpression(node->children[0]);
+    if (type == '\0') {
+        Expr result = failAfter(operand, '#', "Unknown stack operation: " + node->value);
+        result.pure = false;
+        return result;
+    }
+
+    std::string stack;
+    switch (type) {
+        case '#': stack = "sg::intStack"; break;
+        case '~': stack = "sg::floatStack"; break;
+        case '@': stack = "sg::stringStack"; break;
+        default: stack = "sg::booleanStack"; break;
+    }
+
+    if (push) {
+        if (operand.type != type) {
+            return Expr{"((void)(" + operand.code + "), sg::badVariant<int>())", '#', false};
+        }
+        return Expr{"(sg::push<" + cppType(type) + ">(" + stack + ", " + operand.code + ", " + quote(name) + "), 0)",
+                    '#', false};
+    }
+    // ポップ対象の式は評価だけして捨てる
+    return Expr{"((void)(" + operand.code + "), sg::pop<" + cppType(type) + ">(" + stack + ", " + quote(name) + "))",
+                type, false};
+}
+
+// 式の位置にある文（実行して int 0 を返す）
+CppTranspiler::Expr CppTranspiler::emitStatementExpression(const std::shared_ptr<ASTNode>& node) {
+    std::string body;
+    emitStatement(node, body, 0);
+    return Expr{"[&]() -> int {\n" + body + "return 0; }()", '#', false};
+}
+
+// 2つの式を左から順に評価して組み合わせる
+template <typename Combine>
+CppTranspiler::Expr CppTranspiler::sequence(const Expr& left, const Expr& right, char type, Combine combine) {
+    // 片方に副作用がなければ評価順は結果に影響しない
+    if (left.pure || right.pure) {
+        return Expr{combine(left.code, right.code), type, left.pure && right.pure};
+    }
+    std::string l = newTemp();
+    std::string r = newTemp();
+    return Expr{"[&]() -> " + cppType(type) + " { " + cppType(left.type) + " " + l + " = " + left.code + "; " +
+                cppType(right.type) + " " + r + " = " + right.code + "; return " + combine(l, r) + "; }()",
+                type, false};
+}
+
+// 式を評価した後で例外を投げる式
+CppTranspiler::Expr CppTranspiler::failAfter(const Expr& operand, char type, const std::string& message) {
+    return Expr{"((void)(" + operand.code + "), sg::fail<" + cppType(type) + ">(" + quote(message) + "))",
+                type, operand.pure};
+}
+
+// メモリ参照のインデックス（ネストされた参照は内側から解決する）
+std::string CppTranspiler::indexCode(const MemoryDescriptor& mem, bool checkPool) {
+    std::string index = std::to_string(mem.index);
+    bool inRange = mem.index >= 0 && mem.index < static_cast<int>(MEMORY_POOL_SIZE);
+    for (size_t i = mem.indirection.size(); i-- > 0;) {
+        std::string checked = inRange ? index : "sg::checkIndex(" + index + ")";
+        if (mem.indirection[i] == '#') {
+            index = "sg::intPool[" + checked + "]";
+        } else {
+            // int以外の要素はインデックスにできない
+            index = "((void)" + checked + ", sg::badVariant<int>())";
+        }
+        inRange = false;
+    }
+    if (checkPool && !inRange) {
+        return "sg::checkIndex(" + index + ")";
+    }
+    return index;
+}
+
+// プールの要素
+std::string CppTranspiler::poolElement(char type, const std::string& index) {
+    switch (type) {
+        case '#': return "sg::intPool[" + index + "]";
+        case '~': return "sg::floatPool[" + index + "]";
+        case '@': return "sg::stringPool[" + index + "]";
+        case '%': return "sg::boolPool[" + index + "]";
+        default: throw std::runtime_error("Invalid memory type: " + std::string(1, type));
+    }
+}
+
+// メモリマップ
+std::string CppTranspiler::mapObject(char type) {
+    switch (type) {
+        case '#': return "sg::intMap";
+        case '~': return "sg::floatMap";
+        case '@': return "sg::stringMap";
+        case '%': return "sg::boolMap";
+        default: throw std::runtime_error("Unknown memory map type: " + std::string(1, type));
+    }
+}
+
+// 一時変数名
+std::string CppTranspiler::newTemp() {
+    return "t" + std::to_string(tempCount++);
+}
+
+// 文字列リテラル（同じ文字列は1つの定義を共有する）
+std::string CppTranspiler::stringConstant(const std::string& value) {
+    auto it = stringNames.find(value);
+    if (it != stringNames.end()) {
+        return it->second;
+    }
+    std::string name = "literal" + std::to_string(stringConstants.size());
+    stringConstants.push_back("static const std::string " + name + " = " + quote(value) + ";\n");
+    stringNames.emplace(value, name);
+    return name;
+}
+
+// 型記号 → C++の型
+std::string CppTranspiler::cppType(char type) {
+    switch (type) {
+        case '#': return "int";
+        case '~': return "double";
+        case '@': return "std::string";
+        case '%': return "bool";
+        default: return "void";
+    }
+}
@@ -0,0 +1,84 @@
+// SigNum C++ Transpiler
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../ast/ast.hpp"
+
+// 生成コードに埋め込むランタイム（namespace sg）
+extern const char* const CPP_RUNTIME;
+
+// 検査済みのASTを単独でコンパイルできるC++の翻訳単位に変換する
+// - メモリプールは型ごとの配列、関数 _NNN はC++の関数、& ループはwhileになる
+// - スタック・メモリマップ・入出力は埋め込みランタイムを通す
+// - 実行時エラーはInterpreterと同じメッセージで例外を投げる
+class CppTranspiler {
+private:
+    // 生成した式（typeは '#', '~', '@', '%' の型記号）
+    struct Expr {
+        std::string code;
+        char type;
+        bool pure; // スタック操作や関数呼び出しを含まない
+    };
+
+    std::vector<std::string> functionDefinitions; // 生成した関数定義
+    std::vector<std::string> stringConstants;     // 文字列リテラルの定義
+    std::unordered_map<std::string, std::string> stringNames; // 文字列 → 定義名
+    std::unordered_map<std::string, int> functionVersions;   // 関数番号 → 定義の数
+    int tempCount = 0;
+    size_t mapWindowSize = 0; // メモリマップのウィンドウの要素数（0ならランタイムの既定）
+
+    // 文の生成
+    void emitStatement(const std::shared_ptr<ASTNode>& node, std::string& out, int depth);
+    void emitAssignment(const std::shared_ptr<ASTNode>& node, std::string& out, int depth);
+    void emitCompoundAssignment(const std::shared_ptr<ASTNode>& node, std::string& out, int depth);
+    void emitIfStatement(const std::shared_ptr<ASTNode>& node, std::string& out, int depth);
+    void emitLoopStatement(const std::shared_ptr<ASTNode>& node, std::string& out, int depth);
+    void emitFunction(const std::shared_ptr<ASTNode>& node, std::string& out, int depth);
+    void emitInput(const std::shared_ptr<ASTNode>& node, std::string& out, int depth);
+    void emitFileInput(const std::shared_ptr<ASTNode>& node, std::string& out, int depth);
+    void emitFileOutput(const std::shared_ptr<ASTNode>& node, std::string& out, int depth);
+    void emitWindowSlide(const std::shared_ptr<ASTNode>& node, std::string& out, int depth);
+    // 値をメモリ参照に格納する
+    void emitStore(const MemoryDescriptor& mem, const Expr& value, std::string& out, int depth);
+
+    // 式の生成
+    Expr emitExpression(const std::shared_ptr<ASTNode>& node);
+    Expr emitConstant(const std::shared_ptr<ASTNode>& node);
+    Expr emitArithmetic(Operator op, const Expr& left, const Expr& right);
+    Expr emitComparison(Operator op, const Expr& left, const Expr& right);
+    Expr emitLogical(const std::shared_ptr<ASTNode>& node);
+    Expr emitCast(Operator op, const Expr& operand);
+    Expr emitCharCodeCast(Operator op, const Expr& operand);
+    Expr emitStringIndex(const std::shared_ptr<ASTNode>& node);
+    Expr emitStackOperation(const std::shared_ptr<ASTNode>& node);
+    Expr emitStatementExpression(const std::shared_ptr<ASTNode>& node);
+
+    // 2つの式を左から順に評価して組み合わせる
+    template <typename Combine>
+    Expr sequence(const Expr& left, const Expr& right, char type, Combine combine);
+    // 式を評価した後で例外を投げる式
+    Expr failAfter(const Expr& operand, char type, const std::string& message);
+
+    // メモリ参照
+    std::string indexCode(const MemoryDescriptor& mem, bool checkPool);
+    static std::string poolElement(char type, const std::string& index);
+    static std::string mapObject(char type);
+
+    std::string newTemp();
+    std::string stringConstant(const std::string& value);
+
+    static std::string cppType(char type);
+
+public:
+    CppTranspiler() = default;
+
+    // メモリマップのウィンドウの要素数を設定（生成コードの先頭で SG_MAP_WINDOW を定義する）
+    void setMapWindowSize(size_t size) { mapWindowSize = size; }
+
+    // プログラム全体をC++のソースに変換
+    std::string transpile(const std::shared_ptr<ASTNode>& program);
+};
@@ -0,0 +1,138 @@
+// SigNum Bytecode
+
+#include "bytecode.hpp"
+#include <iomanip>
+
+// 命令コードを文字列に変換する関数
+std::string opcode2String(Opcode op) {
+    switch (op) {
+        case Opcode::PushInt: return "PushInt";
+        case Opcode::PushConst: return "PushConst";
+        case Opcode::Pop: return "Pop";
+        case Opcode::LoadInt: return "LoadInt";
+        case Opcode::LoadFloat: return "LoadFloat";
+        case Opcode::LoadString: return "LoadString";
+        case Opcode::LoadBool: return "LoadBool";
+        case Opcode::LoadIndirect: return "LoadIndirect";
+        case Opcode::StoreInt: return "StoreInt";
+        case Opcode::StoreFloat: return "StoreFloat";
+        case Opcode::StoreString: return "StoreString";
+        case Opcode::StoreBool: return "StoreBool";
+        case Opcode::StoreSlot: return "StoreSlot";
+        case Opcode::StoreIndirect: return "StoreIndirect";
+        case Opcode::UpdateInt: return "UpdateInt";
+        case Opcode::AppendString: return "AppendString";
+        case Opcode::LoadMap: return "LoadMap";
+        case Opcode::StoreMap: return "StoreMap";
+        case Opcode::AddInt: return "AddInt";
+        case Opcode::SubInt: return "SubInt";
+        case Opcode::MulInt: return "MulInt";
+        case Opcode::DivInt: return "DivInt";
+        case Opcode::ModInt: return "ModInt";
+        case Opcode::AddFloat: return "AddFloat";
+        case Opcode::SubFloat: return "SubFloat";
+        case Opcode::MulFloat: return "MulFloat";
+        case Opcode::DivFloat: return "DivFloat";
+        case Opcode::EqInt: return "EqInt";
+        case Opcode::NeInt: return "NeInt";
+        case Opcode::LtInt: return "LtInt";
+        case Opcode::LeInt: return "LeInt";
+        case Opcode::GtInt: return "GtInt";
+        case Opcode::GeInt: return "GeInt";
+        case Opcode::EqFloat: return "EqFloat";
+        case Opcode::NeFloat: return "NeFloat";
+        case Opcode::LtFloat: return "LtFloat";
+        case Opcode::LeFloat: return "LeFloat";
+        case Opcode::GtFloat: return "GtFloat";
+        case Opcode::GeFloat: return "GeFloat";
+        case Opcode::Arithmetic: return "Arithmetic";
+        case Opcode::Compare: return "Compare";
+        case Opcode::Cast: return "Cast";
+        case Opcode::CharCodeCast: return "CharCodeCast";
+        case Opcode::And: return "And";
+        case Opcode::Or: return "Or";
+        case Opcode::Not: return "Not";
+        case Opcode::StringIndex: return "StringIndex";
+        case Opcode::StringLength: return "StringLength";
+        case Opcode::StackPush: return "StackPush";
+        case Opcode::StackPop: return "StackPop";
+        case Opcode::Jump: return "Jump";
+        case Opcode::JumpIfNotTrue: return "JumpIfNotTrue";
+        case Opcode::JumpIfFalse: return "JumpIfFalse";
+        case Opcode::DefineFunction: return "DefineFunction";
+        case Opcode::Call: return "Call";
+        case Opcode::CallNative: return "CallNative";
+        case Opcode::Return: return "Return";
+        case Opcode::Output: return "Output";
+        case Opcode::EvalNode: return "EvalNode";
+        case Opcode::ExecNode: return "ExecNode";
+        case Opcode::Halt: return "Halt";
+        default: return "Unknown";
+    }
+}
+
+// 逆アセンブル表示
+void Bytecode::print() const {
+    for (size_t i = 0; i < code.size(); ++i) {
+        const Instruction& inst = code[i];
+        std::cout << std::setw(4) << std::setfill('0') << i << std::setfill(' ')
+                  << "  " << std::left << std::setw(16) << opcode2String(inst.op) << std::right;
+
+        switch (inst.op) {
+            // 型記号を持つ命令
+            case Opcode::LoadIndirect:
+            case Opcode::StoreIndirect:
+            case Opcode::StackPush:
+            case Opcode::StackPop:
+                std::cout << static_cast<char>(inst.a);
+                break;
+            case Opcode::StoreSlot:
+            case Opcode::LoadMap:
+            case Opcode::StoreMap:
+                std::cout << static_cast<char>(inst.a) << " " << inst.b;
+                break;
+            // 演算子を持つ命令
+            case Opcode::Arithmetic:
+            case Opcode::Compare:
+            case Opcode::Cast:
+            case Opcode::CharCodeCast:
+                std::cout << operator2String(static_cast<Operator>(inst.a));
+                break;
+            // ノードを参照する命令
+            case Opcode::EvalNode:
+            case Opcode::ExecNode:
+                std::cout << inst.a << " (" << nodeType2String(nodes[inst.a]->type)
+                          << " " << nodes[inst.a]->value << ")";
+                break;
+            case Opcode::PushConst:
+                std::cout << inst.a << " (" << Interpreter::valueToString(constants[inst.a]) << ")";
+                break;
+            case Opcode::DefineFunction:
+                std::cout << inst.a << " " << inst.b;
+                break;
+            case Opcode::UpdateInt:
+                std::cout << inst.a << " " << operator2String(static_cast<Operator>(inst.b));
+                break;
+            case Opcode::PushInt:
+            case Opcode::LoadInt:
+            case Opcode::LoadFloat:
+            case Opcode::LoadString:
+            case Opcode::LoadBool:
+            case Opcode::StoreInt:
+            case Opcode::StoreFloat:
+            case Opcode::StoreString:
+            case Opcode::StoreBool:
+            case Opcode::AppendString:
+            case Opcode::Jump:
+            case Opcode::JumpIfNotTrue:
+            case Opcode::JumpIfFalse:
+            case Opcode::Call:
+            case Opcode::CallNative:
+                std::cout << inst.a;
+                break;
+            default:
+                break;
+        }
+        std::cout << std::endl;
+    }
+}
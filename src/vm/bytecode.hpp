@@ -0,0 +1,125 @@
+// SigNum Bytecode
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <memory>
+#include "../ast/ast.hpp"
+#include "../interpreter/interpreter.hpp"
+
+// 命令コード
+enum class Opcode : uint8_t {
+    // 定数
+    PushInt,        // a: 即値
+    PushConst,      // a: 定数テーブルのインデックス
+    Pop,
+
+    // メモリプール
+    LoadInt,        // a: スロット番号
+    LoadFloat,
+    LoadString,
+    LoadBool,
+    LoadIndirect,   // a: 型記号 (スタックトップのintをインデックスとして使う)
+    StoreInt,       // a: スロット番号
+    StoreFloat,
+    StoreString,
+    StoreBool,
+    StoreSlot,      // a: 型記号, b: スロット番号 (型が静的に分からない場合)
+    StoreIndirect,  // a: 型記号 (スタック: 値, インデックス)
+    UpdateInt,      // a: スロット番号, b: Operator (複合代入)
+    AppendString,   // a: スロット番号 (@ への +=)
+
+    // メモリマップ
+    LoadMap,        // a: 型記号, b: インデックス
+    StoreMap,       // a: 型記号, b: インデックス
+
+    // int同士の算術演算
+    AddInt,
+    SubInt,
+    MulInt,
+    DivInt,
+    ModInt,
+
+    // float同士の算術演算
+    AddFloat,
+    SubFloat,
+    MulFloat,
+    DivFloat,
+
+    // int同士の比較
+    EqInt,
+    NeInt,
+    LtInt,
+    LeInt,
+    GtInt,
+    GeInt,
+
+    // float同士の比較
+    EqFloat,
+    NeFloat,
+    LtFloat,
+    LeFloat,
+    GtFloat,
+    GeFloat,
+
+    // 汎用演算 (a: Operator)
+    Arithmetic,
+    Compare,
+    Cast,
+    CharCodeCast,
+
+    // 論理演算
+    And,
+    Or,
+    Not,
+
+    // 文字列
+    StringIndex,
+    StringLength,
+
+    // スタック (a: 型記号)
+    StackPush,
+    StackPop,
+
+    // 制御
+    Jump,           // a: ジャンプ先
+    JumpIfNotTrue,  // a: ジャンプ先 (条件分岐用)
+    JumpIfFalse,    // a: ジャンプ先 (ループ用)
+    DefineFunction, // a: 関数ID, b: 関数本体の先頭
+    Call,           // a: 関数ID
+    CallNative,     // a: 関数ID（ネイティブ関数）
+    Return,
+
+    // 入出力
+    Output,
+
+    // ツリーウォーカーへの委譲 (a: ノードテーブルのインデックス)
+    EvalNode,       // 結果をスタックに積む
+    ExecNode,       // 結果を捨てる
+
+    Halt
+};
+
+// 命令
+struct Instruction {
+    Opcode op;
+    int32_t a = 0;
+    int32_t b = 0;
+};
+
+// コンパイル済みプログラム
+struct Bytecode {
+    std::vector<Instruction> code;                  // 命令列
+    std::vector<Value> constants;                   // 定数テーブル
+    std::vector<std::shared_ptr<ASTNode>> nodes;    // 汎用演算・委譲用のノード
+    std::unordered_map<int32_t, std::shared_ptr<ASTNode>> functionBodies; // 本体の先頭 → 関数定義のノード
+
+    // 逆アセンブル表示
+    void print() const;
+};
+
+// 命令コードを文字列に変換
+std::string opcode2String(Opcode op);
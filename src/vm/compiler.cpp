@@ -0,0 +1,537 @@
+// SigNum Bytecode Compiler
+
+#include "compiler.hpp"
+#include "../native/native.hpp"
+
+// 型記号から値の種類を取得
+static ValueKind kindFromType(char type) {
+    switch (type) {
+        case '#': return ValueKind::Int;
+        case '~': return ValueKind::Float;
+        case '@': return ValueKind::String;
+        case '%': return ValueKind::Bool;
+        default: return ValueKind::Unknown;
+    }
+}
+
+// 型記号に対応する読み込み命令
+static Opcode loadOpcode(char type) {
+    switch (type) {
+        case '#': return Opcode::LoadInt;
+        case '~': return Opcode::LoadFloat;
+        case '@': return Opcode::LoadString;
+        default: return Opcode::LoadBool;
+    }
+}
+
+// 型記号に対応する書き込み命令
+static Opcode storeOpcode(char type) {
+    switch (type) {
+        case '#': return Opcode::StoreInt;
+        case '~': return Opcode::StoreFloat;
+        case '@': return Opcode::StoreString;
+        default: return Opcode::StoreBool;
+    }
+}
+
+// 静的に解決できるメモリ参照か（外側から順の型記号列を返す）
+static bool staticMemoryTypes(const MemoryDescriptor& mem, bool isMap, std::string& types) {
+    if (!mem.valid || mem.isMap != isMap) {
+        return false;
+    }
+    if (isMap) {
+        // メモリマップはインデックスが静的な場合のみ
+        types = std::string(1, mem.type);
+        return mem.indirection.empty();
+    }
+    types = std::string(1, mem.type) + mem.indirection;
+    return mem.index < static_cast<int>(MEMORY_POOL_SIZE);
+}
+
+// プログラム全体をコンパイル
+Bytecode BytecodeCompiler::compile(const std::shared_ptr<ASTNode>& root) {
+    program = Bytecode();
+    pendingFunctions.clear();
+
+    compileStatement(root);
+    emit(Opcode::Halt);
+
+    // 関数本体はメインの後ろに配置（本体内の関数定義で増えることがある）
+    for (size_t i = 0; i < pendingFunctions.size(); ++i) {
+        PendingFunction function = pendingFunctions[i];
+        program.code[function.defineIndex].b = static_cast<int32_t>(program.code.size());
+        program.functionBodies[program.code[function.defineIndex].b] = function.node;
+        for (const auto& child : function.node->children) {
+            compileStatement(child);
+        }
+        emit(Opcode::Return);
+    }
+
+    return std::move(program);
+}
+
+// 命令の追加
+size_t BytecodeCompiler::emit(Opcode op, int32_t a, int32_t b) {
+    program.code.push_back({op, a, b});
+    return program.code.size() - 1;
+}
+
+// ジャンプ先を現在位置に書き換え
+void BytecodeCompiler::patchJump(size_t index) {
+    program.code[index].a = static_cast<int32_t>(program.code.size());
+}
+
+// ノードの登録
+int32_t BytecodeCompiler::addNode(const std::shared_ptr<ASTNode>& node) {
+    program.nodes.push_back(node);
+    return static_cast<int32_t>(program.nodes.size() - 1);
+}
+
+// 定数の登録
+int32_t BytecodeCompiler::addConstant(const Value& value) {
+    program.constants.push_back(value);
+    return static_cast<int32_t>(program.constants.size() - 1);
+}
+
+// 文のコンパイル
+void BytecodeCompiler::compileStatement(const std::shared_ptr<ASTNode>& node) {
+    switch (node->type) {
+        case NodeType::Program:
+        case NodeType::Statement:
+            for (const auto& child : node->children) {
+                compileStatement(child);
+            }
+            break;
+
+        case NodeType::Function: {
+            size_t index = emit(Opcode::DefineFunction, std::stoi(node->value));
+            pendingFunctions.push_back({node, index});
+            break;
+        }
+
+        case NodeType::FunctionCall: {
+            int id = std::stoi(node->value);
+            emit(NativeRegistry::find(id) ? Opcode::CallNative : Opcode::Call, id);
+            break;
+        }
+
+        case NodeType::Assignment:
+            compileAssignment(node);
+            break;
+
+        case NodeType::IfStatement:
+            compileIfStatement(node);
+            break;
+
+        case NodeType::LoopStatement:
+            compileLoopStatement(node);
+            break;
+
+        case NodeType::OutputStatement:
+            if (node->children.empty()) {
+                emit(Opcode::ExecNode, addNode(node));
+                break;
+            }
+            compileExpression(node->children[0]);
+            emit(Opcode::Output);
+            break;
+
+        case NodeType::StackOperation:
+            compileStackOperation(node, true);
+            break;
+
+        // 入出力やウィンドウスライドはツリーウォーカーに任せる
+        case NodeType::InputStatement:
+        case NodeType::FileInputStatement:
+        case NodeType::FileOutputStatement:
+        case NodeType::MapWindowSlide:
+        case NodeType::Error:
+            emit(Opcode::ExecNode, addNode(node));
+            break;
+
+        // 式文
+        default:
+            compileExpression(node);
+            emit(Opcode::Pop);
+            break;
+    }
+}
+
+// 代入のコンパイル
+void BytecodeCompiler::compileAssignment(const std::shared_ptr<ASTNode>& node) {
+    if (node->children.size() < 2) {
+        emit(Opcode::ExecNode, addNode(node));
+        return;
+    }
+
+    const auto& target = node->children[0];
+    const MemoryDescriptor& mem = target->memory;
+    std::string types;
+
+    // メモリマップへの代入
+    if (target->type == NodeType::MemoryMapRef) {
+        if (!staticMemoryTypes(mem, true, types)) {
+            emit(Opcode::ExecNode, addNode(node));
+            return;
+        }
+        compileExpression(node->children[1]);
+        emit(Opcode::StoreMap, mem.type, mem.index);
+        return;
+    }
+
+    // メモリプールへの代入
+    if (target->type != NodeType::MemoryRef || !staticMemoryTypes(mem, false, types)) {
+        emit(Opcode::ExecNode, addNode(node));
+        return;
+    }
+
+    int index = mem.index;
+
+    // 複合代入はその場で更新する
+    const auto& source = node->children[1];
+    if (node->op != Operator::None && types.size() == 1 &&
+        source->type == NodeType::ArithmeticExpression && source->children.size() == 2) {
+        if (types[0] == '#' && node->op >= Operator::Add && node->op <= Operator::Modulus) {
+            size_t start = program.code.size();
+            if (compileExpression(source->children[1]) == ValueKind::Int) {
+                emit(Opcode::UpdateInt, index, static_cast<int32_t>(node->op));
+                return;
+            }
+            // 型が分からなければ通常の代入としてやり直す
+            program.code.resize(start);
+        }
+        else if (types[0] == '@' && node->op == Operator::Add) {
+            compileExpression(source->children[1]);
+            emit(Opcode::AppendString, index);
+            return;
+        }
+    }
+
+    ValueKind kind = compileExpression(node->children[1]);
+    if (types.size() == 1) {
+        if (kind == kindFromType(types[0])) {
+            emit(storeOpcode(types[0]), index);
+        }
+        else {
+            emit(Opcode::StoreSlot, types[0], index);
+        }
+        return;
+    }
+
+    // ネストされた参照：内側の参照でインデックスを求める
+    emit(loadOpcode(types.back()), index);
+    for (size_t i = types.size() - 2; i > 0; --i) {
+        emit(Opcode::LoadIndirect, types[i]);
+    }
+    emit(Opcode::StoreIndirect, types[0]);
+}
+
+// 条件分岐のコンパイル
+void BytecodeCompiler::compileIfStatement(const std::shared_ptr<ASTNode>& node) {
+    const auto& children = node->children;
+    if (children.size() < 2) {
+        emit(Opcode::ExecNode, addNode(node));
+        return;
+    }
+
+    std::vector<size_t> endJumps;
+
+    compileExpression(children[0]);
+    size_t skip = emit(Opcode::JumpIfNotTrue);
+    compileStatement(children[1]);
+    endJumps.push_back(emit(Opcode::Jump));
+    patchJump(skip);
+
+    // else if / else（2つ置きに条件と本体、最後の1つはelse）
+    for (size_t i = 2; i < children.size(); i += 2) {
+        if (i == children.size() - 1) {
+            compileStatement(children[i]);
+            break;
+        }
+        compileExpression(children[i]);
+        skip = emit(Opcode::JumpIfNotTrue);
+        compileStatement(children[i + 1]);
+        endJumps.push_back(emit(Opcode::Jump));
+        patchJump(skip);
+    }
+
+    for (size_t jump : endJumps) {
+        patchJump(jump);
+    }
+}
+
+// ループのコンパイル
+void BytecodeCompiler::compileLoopStatement(const std::shared_ptr<ASTNode>& node) {
+    if (node->children.size() < 2) {
+        emit(Opcode::ExecNode, addNode(node));
+        return;
+    }
+
+    int32_t top = static_cast<int32_t>(program.code.size());
+    compileExpression(node->children[0]);
+    size_t exit = emit(Opcode::JumpIfFalse);
+    compileStatement(node->children[1]);
+    emit(Opcode::Jump, top);
+    patchJump(exit);
+}
+
+// 式のコンパイル
+ValueKind BytecodeCompiler::compileExpression(const std::shared_ptr<ASTNode>& node) {
+    switch (node->type) {
+        // リテラル・定数
+        case NodeType::Number:
+        case NodeType::String:
+        case NodeType::Constant: {
+            if (!node->constant) {
+                return compileFallback(node);
+            }
+            const Value& value = *node->constant;
+            if (std::holds_alternative<int>(value)) {
+                emit(Opcode::PushInt, std::get<int>(value));
+                return ValueKind::Int;
+            }
+            emit(Opcode::PushConst, addConstant(value));
+            if (std::holds_alternative<double>(value)) return ValueKind::Float;
+            if (std::holds_alternative<std::string>(value)) return ValueKind::String;
+            return ValueKind::Bool;
+        }
+
+        case NodeType::MemoryRef:
+            return compileMemoryRef(node);
+
+        case NodeType::MemoryMapRef: {
+            std::string types;
+            if (!staticMemoryTypes(node->memory, true, types)) {
+                return compileFallback(node);
+            }
+            emit(Opcode::LoadMap, node->memory.type, node->memory.index);
+            return kindFromType(node->memory.type);
+        }
+
+        case NodeType::ArithmeticExpression:
+            return compileArithmetic(node);
+
+        case NodeType::LogicalExpression:
+            return compileLogical(node);
+
+        case NodeType::Comparison:
+            return compileComparison(node);
+
+        case NodeType::Cast: {
+            if (node->children.empty()) {
+                return compileFallback(node);
+            }
+            compileExpression(node->children[0]);
+            emit(Opcode::Cast, static_cast<int32_t>(node->op));
+            switch (node->op) {
+                case Operator::IntCast: return ValueKind::Int;
+                case Operator::FloatCast: return ValueKind::Float;
+                case Operator::StringCast: return ValueKind::String;
+                case Operator::BoolCast: return ValueKind::Bool;
+                default: return ValueKind::Unknown;
+            }
+        }
+
+        case NodeType::CharCodeCast: {
+            if (node->children.empty()) {
+                return compileFallback(node);
+            }
+            compileExpression(node->children[0]);
+            emit(Opcode::CharCodeCast, static_cast<int32_t>(node->op));
+            if (node->op == Operator::CharToInt) return ValueKind::Int;
+            if (node->op == Operator::IntToChar) return ValueKind::String;
+            return ValueKind::Unknown;
+        }
+
+        case NodeType::StringIndex:
+            if (node->children.size() < 2) {
+                return compileFallback(node);
+            }
+            compileExpression(node->children[0]);
+            compileExpression(node->children[1]);
+            emit(Opcode::StringIndex);
+            return ValueKind::String;
+
+        case NodeType::StringLength:
+            if (node->children.empty()) {
+                return compileFallback(node);
+            }
+            compileExpression(node->children[0]);
+            emit(Opcode::StringLength);
+            return ValueKind::Int;
+
+        case NodeType::StackOperation:
+            return compileStackOperation(node, false);
+
+        default:
+            return compileFallback(node);
+    }
+}
+
+// メモリ参照のコンパイル
+ValueKind BytecodeCompiler::compileMemoryRef(const std::shared_ptr<ASTNode>& node) {
+    std::string types;
+    if (!staticMemoryTypes(node->memory, false, types)) {
+        return compileFallback(node);
+    }
+
+    // 一番内側から順に解決
+    emit(loadOpcode(types.back()), node->memory.index);
+    for (size_t i = types.size() - 1; i > 0; --i) {
+        emit(Opcode::LoadIndirect, types[i - 1]);
+    }
+    return kindFromType(types[0]);
+}
+
+// 算術式のコンパイル
+ValueKind BytecodeCompiler::compileArithmetic(const std::shared_ptr<ASTNode>& node) {
+    if (node->children.size() == 1) {
+        return compileExpression(node->children[0]);
+    }
+    if (node->children.size() != 2) {
+        return compileFallback(node);
+    }
+
+    ValueKind left = compileExpression(node->children[0]);
+    ValueKind right = compileExpression(node->children[1]);
+    Operator op = node->op;
+
+    // int同士
+    if (left == ValueKind::Int && right == ValueKind::Int) {
+        switch (op) {
+            case Operator::Add: emit(Opcode::AddInt); return ValueKind::Int;
+            case Operator::Subtract: emit(Opcode::SubInt); return ValueKind::Int;
+            case Operator::Multiply: emit(Opcode::MulInt); return ValueKind::Int;
+            case Operator::Divide: emit(Opcode::DivInt); return ValueKind::Int;
+            case Operator::Modulus: emit(Opcode::ModInt); return ValueKind::Int;
+            default: break;
+        }
+    }
+    // float同士
+    else if (left == ValueKind::Float && right == ValueKind::Float) {
+        switch (op) {
+            case Operator::Add: emit(Opcode::AddFloat); return ValueKind::Float;
+            case Operator::Subtract: emit(Opcode::SubFloat); return ValueKind::Float;
+            case Operator::Multiply: emit(Opcode::MulFloat); return ValueKind::Float;
+            case Operator::Divide: emit(Opcode::DivFloat); return ValueKind::Float;
+            default: break;
+        }
+    }
+
+    // それ以外は汎用演算
+    emit(Opcode::Arithmetic, static_cast<int32_t>(op));
+
+    if (left == ValueKind::Unknown || right == ValueKind::Unknown) {
+        return ValueKind::Unknown;
+    }
+    if (left == ValueKind::String || right == ValueKind::String) {
+        return op == Operator::Add ? ValueKind::String : ValueKind::Unknown;
+    }
+    if (left == ValueKind::Float || right == ValueKind::Float) {
+        return op == Operator::Modulus ? ValueKind::Unknown : ValueKind::Float;
+    }
+    return ValueKind::Int;
+}
+
+// 比較式のコンパイル
+ValueKind BytecodeCompiler::compileComparison(const std::shared_ptr<ASTNode>& node) {
+    if (node->children.size() != 2) {
+        return compileFallback(node);
+    }
+
+    ValueKind left = compileExpression(node->children[0]);
+    ValueKind right = compileExpression(node->children[1]);
+    Operator op = node->op;
+
+    // int同士
+    if (left == ValueKind::Int && right == ValueKind::Int) {
+        switch (op) {
+            case Operator::Equal: emit(Opcode::EqInt); return ValueKind::Bool;
+            case Operator::NotEqual: emit(Opcode::NeInt); return ValueKind::Bool;
+            case Operator::Less: emit(Opcode::LtInt); return ValueKind::Bool;
+            case Operator::LessEqual: emit(Opcode::LeInt); return ValueKind::Bool;
+            case Operator::Greater: emit(Opcode::GtInt); return ValueKind::Bool;
+            case Operator::GreaterEqual: emit(Opcode::GeInt); return ValueKind::Bool;
+            default: break;
+        }
+    }
+    // float同士
+    else if (left == ValueKind::Float && right == ValueKind::Float) {
+        switch (op) {
+            case Operator::Equal: emit(Opcode::EqFloat); return ValueKind::Bool;
+            case Operator::NotEqual: emit(Opcode::NeFloat); return ValueKind::Bool;
+            case Operator::Less: emit(Opcode::LtFloat); return ValueKind::Bool;
+            case Operator::LessEqual: emit(Opcode::LeFloat); return ValueKind::Bool;
+            case Operator::Greater: emit(Opcode::GtFloat); return ValueKind::Bool;
+            case Operator::GreaterEqual: emit(Opcode::GeFloat); return ValueKind::Bool;
+            default: break;
+        }
+    }
+
+    emit(Opcode::Compare, static_cast<int32_t>(op));
+    return ValueKind::Bool;
+}
+
+// 論理式のコンパイル
+ValueKind BytecodeCompiler::compileLogical(const std::shared_ptr<ASTNode>& node) {
+    // 単項式
+    if (node->children.size() == 1) {
+        if (node->op == Operator::Not) {
+            compileExpression(node->children[0]);
+            emit(Opcode::Not);
+            return ValueKind::Bool;
+        }
+        return compileExpression(node->children[0]);
+    }
+    // 二項式
+    if (node->children.size() == 2 && (node->op == Operator::And || node->op == Operator::Or)) {
+        compileExpression(node->children[0]);
+        compileExpression(node->children[1]);
+        emit(node->op == Operator::And ? Opcode::And : Opcode::Or);
+        return ValueKind::Bool;
+    }
+    return compileFallback(node);
+}
+
+// スタック操作のコンパイル
+ValueKind BytecodeCompiler::compileStackOperation(const std::shared_ptr<ASTNode>& node, bool discard) {
+    char type = '\0';
+    bool push = false;
+    switch (node->op) {
+        case Operator::IntegerStackPush: type = '#'; push = true; break;
+        case Operator::IntegerStackPop: type = '#'; break;
+        case Operator::FloatStackPush: type = '~'; push = true; break;
+        case Operator::FloatStackPop: type = '~'; break;
+        case Operator::StringStackPush: type = '@'; push = true; break;
+        case Operator::StringStackPop: type = '@'; break;
+        case Operator::BooleanStackPush: type = '%'; push = true; break;
+        case Operator::BooleanStackPop: type = '%'; break;
+        default: break;
+    }
+
+    if (type == '\0' || node->children.empty()) {
+        ValueKind kind = compileFallback(node);
+        if (discard) emit(Opcode::Pop);
+        return kind;
+    }
+
+    compileExpression(node->children[0]);
+    if (push) {
+        emit(Opcode::StackPush, type);
+        // プッシュの結果は空の値
+        if (!discard) emit(Opcode::PushInt, 0);
+        return ValueKind::Int;
+    }
+
+    // ポップ対象の式は評価だけして捨てる
+    emit(Opcode::Pop);
+    emit(Opcode::StackPop, type);
+    if (discard) emit(Opcode::Pop);
+    return kindFromType(type);
+}
+
+// ツリーウォーカーに委譲
+ValueKind BytecodeCompiler::compileFallback(const std::shared_ptr<ASTNode>& node) {
+    emit(Opcode::EvalNode, addNode(node));
+    return ValueKind::Unknown;
+}
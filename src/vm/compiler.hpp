@@ -0,0 +1,61 @@
+// SigNum Bytecode Compiler
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include "bytecode.hpp"
+
+// 静的に分かる値の種類
+enum class ValueKind {
+    Int,
+    Float,
+    String,
+    Bool,
+    Unknown // 実行時まで分からない
+};
+
+// バイトコードコンパイラ
+class BytecodeCompiler {
+private:
+    Bytecode program;
+
+    // 後でコンパイルする関数本体
+    struct PendingFunction {
+        std::shared_ptr<ASTNode> node;
+        size_t defineIndex; // DefineFunction命令の位置
+    };
+    std::vector<PendingFunction> pendingFunctions;
+
+    // 命令の追加
+    size_t emit(Opcode op, int32_t a = 0, int32_t b = 0);
+    // ジャンプ先の書き換え
+    void patchJump(size_t index);
+    // ノード・定数の登録
+    int32_t addNode(const std::shared_ptr<ASTNode>& node);
+    int32_t addConstant(const Value& value);
+
+    // 文のコンパイル
+    void compileStatement(const std::shared_ptr<ASTNode>& node);
+    void compileAssignment(const std::shared_ptr<ASTNode>& node);
+    void compileIfStatement(const std::shared_ptr<ASTNode>& node);
+    void compileLoopStatement(const std::shared_ptr<ASTNode>& node);
+
+    // 式のコンパイル
+    ValueKind compileExpression(const std::shared_ptr<ASTNode>& node);
+    ValueKind compileMemoryRef(const std::shared_ptr<ASTNode>& node);
+    ValueKind compileArithmetic(const std::shared_ptr<ASTNode>& node);
+    ValueKind compileComparison(const std::shared_ptr<ASTNode>& node);
+    ValueKind compileLogical(const std::shared_ptr<ASTNode>& node);
+    ValueKind compileStackOperation(const std::shared_ptr<ASTNode>& node, bool discard);
+
+    // ツリーウォーカーに委譲
+    ValueKind compileFallback(const std::shared_ptr<ASTNode>& node);
+
+public:
+    BytecodeCompiler() = default;
+
+    // プログラム全体をコンパイル
+    Bytecode compile(const std::shared_ptr<ASTNode>& root);
+};
@@ -0,0 +1,358 @@
+// SigNum Virtual Machine
+
+#include "vm.hpp"
+#include "../native/native.hpp"
+
+VirtualMachine::VirtualMachine(Interpreter& interpreter) : interpreter(interpreter) {
+    stack.reserve(256);
+    functionTable.fill(-1);
+}
+
+// 実行
+void VirtualMachine::run(const Bytecode& program) {
+    functionTable.fill(-1);
+    resume(program, 0);
+}
+
+// 関数表を残したまま entry の命令から実行
+void VirtualMachine::resume(const Bytecode& program, size_t entry) {
+    const Instruction* code = program.code.data();
+    size_t pc = entry;
+
+    stack.clear();
+    callStack.clear();
+
+    while (true) {
+        const Instruction& inst = code[pc++];
+        switch (inst.op) {
+            // 定数
+            case Opcode::PushInt:
+                stack.emplace_back(static_cast<int>(inst.a));
+                break;
+            case Opcode::PushConst:
+                stack.push_back(program.constants[inst.a]);
+                break;
+            case Opcode::Pop:
+                stack.pop_back();
+                break;
+
+            // メモリプール
+            case Opcode::LoadInt:
+                stack.push_back(interpreter.intPool[inst.a]);
+                break;
+            case Opcode::LoadFloat:
+                stack.push_back(interpreter.floatPool[inst.a]);
+                break;
+            case Opcode::LoadString:
+                stack.push_back(interpreter.stringPool[inst.a]);
+                break;
+            case Opcode::LoadBool:
+                stack.push_back(static_cast<bool>(interpreter.boolPool[inst.a]));
+                break;
+            case Opcode::LoadIndirect: {
+                Value& top = stack.back();
+                top = interpreter.getMemoryValue(static_cast<char>(inst.a), std::get<int>(top));
+                break;
+            }
+            case Opcode::StoreInt:
+                store<int>(interpreter.intPool[inst.a], '#', inst.a);
+                break;
+            case Opcode::StoreFloat:
+                store<double>(interpreter.floatPool[inst.a], '~', inst.a);
+                break;
+            case Opcode::StoreString:
+                store<std::string>(interpreter.stringPool[inst.a], '@', inst.a);
+                break;
+            case Opcode::StoreBool:
+                store<bool>(interpreter.boolPool[inst.a], '%', inst.a);
+                break;
+            case Opcode::StoreSlot:
+                interpreter.setMemoryValue(static_cast<char>(inst.a), inst.b, stack.back());
+                stack.pop_back();
+                break;
+            case Opcode::StoreIndirect: {
+                int index = std::get<int>(stack.back());
+                stack.pop_back();
+                interpreter.setMemoryValue(static_cast<char>(inst.a), index, stack.back());
+                stack.pop_back();
+                break;
+            }
+
+            // 複合代入
+            case Opcode::UpdateInt: {
+                int operand = std::get<int>(stack.back());
+                stack.pop_back();
+                int& slot = interpreter.intPool[inst.a];
+                switch (static_cast<Operator>(inst.b)) {
+                    case Operator::Add: slot += operand; break;
+                    case Operator::Subtract: slot -= operand; break;
+                    case Operator::Multiply: slot *= operand; break;
+                    case Operator::Divide:
+                        if (operand == 0) throw std::runtime_error("Division by zero");
+                        slot /= operand;
+                        break;
+                    case Operator::Modulus:
+                        if (operand == 0) throw std::runtime_error("Modulo by zero");
+                        slot %= operand;
+                        break;
+                    default:
+                        throw std::runtime_error("Invalid compound assignment");
+                }
+                break;
+            }
+            case Opcode::AppendString: {
+                std::string& slot = interpreter.stringPool[inst.a];
+                if (const std::string* value = std::get_if<std::string>(&stack.back())) {
+                    slot += *value;
+                } else {
+                    slot += Interpreter::valueToString(stack.back());
+                }
+                stack.pop_back();
+                break;
+            }
+
+            // メモリマップ
+            case Opcode::LoadMap:
+                stack.push_back(interpreter.readMemoryMap(static_cast<char>(inst.a), inst.b));
+                break;
+            case Opcode::StoreMap:
+                interpreter.writeMemoryMap(static_cast<char>(inst.a), inst.b, stack.back());
+                stack.pop_back();
+                break;
+
+            // int同士の算術演算
+            case Opcode::AddInt:
+                binary<int>([](int l, int r) { return l + r; });
+                break;
+            case Opcode::SubInt:
+                binary<int>([](int l, int r) { return l - r; });
+                break;
+            case Opcode::MulInt:
+                binary<int>([](int l, int r) { return l * r; });
+                break;
+            case Opcode::DivInt:
+                binary<int>([](int l, int r) {
+                    if (r == 0) throw std::runtime_error("Division by zero");
+                    return l / r;
+                });
+                break;
+            case Opcode::ModInt:
+                binary<int>([](int l, int r) {
+                    if (r == 0) throw std::runtime_error("Modulo by zero");
+                    return l % r;
+                });
+                break;
+
+            // float同士の算術演算
+            case Opcode::AddFloat:
+                binary<double>([](double l, double r) { return l + r; });
+                break;
+            case Opcode::SubFloat:
+                binary<double>([](double l, double r) { return l - r; });
+                break;
+            case Opcode::MulFloat:
+                binary<double>([](double l, double r) { return l * r; });
+                break;
+            case Opcode::DivFloat:
+                binary<double>([](double l, double r) {
+                    if (r == 0.0) throw std::runtime_error("Division by zero");
+                    return l / r;
+                });
+                break;
+
+            // int同士の比較
+            case Opcode::EqInt:
+                binary<int>([](int l, int r) { return l == r; });
+                break;
+            case Opcode::NeInt:
+                binary<int>([](int l, int r) { return l != r; });
+                break;
+            case Opcode::LtInt:
+                binary<int>([](int l, int r) { return l < r; });
+                break;
+            case Opcode::LeInt:
+                binary<int>([](int l, int r) { return l <= r; });
+                break;
+            case Opcode::GtInt:
+                binary<int>([](int l, int r) { return l > r; });
+                break;
+            case Opcode::GeInt:
+                binary<int>([](int l, int r) { return l >= r; });
+                break;
+
+            // float同士の比較
+            case Opcode::EqFloat:
+                binary<double>([](double l, double r) { return l == r; });
+                break;
+            case Opcode::NeFloat:
+                binary<double>([](double l, double r) { return l != r; });
+                break;
+            case Opcode::LtFloat:
+                binary<double>([](double l, double r) { return l < r; });
+                break;
+            case Opcode::LeFloat:
+                binary<double>([](double l, double r) { return l <= r; });
+                break;
+            case Opcode::GtFloat:
+                binary<double>([](double l, double r) { return l > r; });
+                break;
+            case Opcode::GeFloat:
+                binary<double>([](double l, double r) { return l >= r; });
+                break;
+
+            // 汎用演算
+            case Opcode::Arithmetic: {
+                Value right = pop();
+                Value& left = stack.back();
+                left = Interpreter::applyArithmetic(static_cast<Operator>(inst.a), left, right);
+                break;
+            }
+            case Opcode::Compare: {
+                Value right = pop();
+                Value& left = stack.back();
+                left = Interpreter::applyComparison(static_cast<Operator>(inst.a), left, right);
+                break;
+            }
+            case Opcode::Cast: {
+                Value& value = stack.back();
+                value = Interpreter::applyCast(static_cast<Operator>(inst.a), value);
+                break;
+            }
+            case Opcode::CharCodeCast: {
+                Value& value = stack.back();
+                value = Interpreter::applyCharCodeCast(static_cast<Operator>(inst.a), value);
+                break;
+            }
+
+            // 論理演算
+            case Opcode::And:
+            case Opcode::Or: {
+                Value right = pop();
+                Value& left = stack.back();
+                if (!std::holds_alternative<bool>(left) || !std::holds_alternative<bool>(right)) {
+                    throw std::runtime_error("Invalid logical expression: " + Interpreter::valueToString(left) +
+                                             (inst.op == Opcode::And ? " && " : " || ") +
+                                             Interpreter::valueToString(right));
+                }
+                bool result = (inst.op == Opcode::And)
+                    ? (std::get<bool>(left) && std::get<bool>(right))
+                    : (std::get<bool>(left) || std::get<bool>(right));
+                left = result;
+                break;
+            }
+            case Opcode::Not: {
+                Value& value = stack.back();
+                if (!std::holds_alternative<bool>(value)) {
+                    throw std::runtime_error("Invalid logical negation: " + Interpreter::valueToString(value));
+                }
+                value = !std::get<bool>(value);
+                break;
+            }
+
+            // 文字列
+            case Opcode::StringIndex: {
+                Value indexValue = pop();
+                Value& memValue = stack.back();
+                if (!std::holds_alternative<std::string>(memValue)) {
+                    throw std::runtime_error("String index can only be used on string type");
+                }
+                if (!std::holds_alternative<int>(indexValue)) {
+                    throw std::runtime_error("String index must be integer type");
+                }
+                const std::string& str = std::get<std::string>(memValue);
+                int index = std::get<int>(indexValue);
+                if (index < 0 || index >= static_cast<int>(str.length())) {
+                    throw std::out_of_range("String index out of range: " + std::to_string(index) +
+                                            " (string length: " + std::to_string(str.length()) + ")");
+                }
+                Value result = std::string(1, str[index]);
+                memValue = std::move(result);
+                break;
+            }
+            case Opcode::StringLength: {
+                Value& value = stack.back();
+                if (!std::holds_alternative<std::string>(value)) {
+                    throw std::runtime_error("String length can only be used on string type");
+                }
+                int length = static_cast<int>(std::get<std::string>(value).length());
+                value = length;
+                break;
+            }
+
+            // スタック
+            case Opcode::StackPush:
+                interpreter.pushStack(static_cast<char>(inst.a), stack.back());
+                stack.pop_back();
+                break;
+            case Opcode::StackPop:
+                stack.push_back(interpreter.popStack(static_cast<char>(inst.a)));
+                break;
+
+            // 制御
+            case Opcode::Jump:
+                pc = inst.a;
+                break;
+            case Opcode::JumpIfNotTrue: {
+                // 条件分岐：trueのときだけ本体に入る
+                const bool* condition = std::get_if<bool>(&stack.back());
+                bool taken = condition && *condition;
+                stack.pop_back();
+                if (!taken) pc = inst.a;
+                break;
+            }
+            case Opcode::JumpIfFalse: {
+                // ループ：falseのときだけ抜ける
+                const bool* condition = std::get_if<bool>(&stack.back());
+                bool exit = condition && !*condition;
+                stack.pop_back();
+                if (exit) pc = inst.a;
+                break;
+            }
+            case Opcode::DefineFunction:
+                functionTable[inst.a] = inst.b;
+                // スナップショット用に関数テーブルにも残す
+                interpreter.functions[inst.a] = program.functionBodies.at(inst.b);
+                ++interpreter.functionsVersion;
+                break;
+            case Opcode::Call: {
+                int32_t entry = functionTable[inst.a];
+                if (entry < 0) {
+                    std::string id = std::to_string(inst.a);
+                    throw std::runtime_error("Function not found: " + std::string(3 - id.size(), '0') + id);
+                }
+                callStack.push_back(pc);
+                pc = entry;
+                break;
+            }
+            case Opcode::CallNative: {
+                const NativeFunction* native = NativeRegistry::find(inst.a);
+                if (!native) {
+                    throw std::runtime_error("Function not found: " + std::to_string(inst.a));
+                }
+                (*native)(interpreter);
+                break;
+            }
+            case Opcode::Return:
+                pc = callStack.back();
+                callStack.pop_back();
+                break;
+
+            // 入出力
+            case Opcode::Output:
+                interpreter.writeLine(stack.back());
+                stack.pop_back();
+                break;
+
+            // ツリーウォーカーへの委譲
+            case Opcode::EvalNode:
+                stack.push_back(interpreter.evaluateNode(program.nodes[inst.a]));
+                break;
+            case Opcode::ExecNode:
+                interpreter.evaluateNode(program.nodes[inst.a]);
+                break;
+
+            case Opcode::Halt:
+                return;
+        }
+    }
+}
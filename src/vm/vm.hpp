@@ -0,0 +1,56 @@
+// SigNum Virtual Machine
+
+#pragma once
+
+#include <array>
+#include <vector>
+#include "bytecode.hpp"
+#include "../interpreter/interpreter.hpp"
+
+// 関数IDの最大値
+constexpr size_t FUNCTION_ID_MAX = 999;
+
+// バイトコード仮想マシン
+// メモリプール・スタック・メモリマップはInterpreterのものをそのまま使う
+class VirtualMachine {
+private:
+    Interpreter& interpreter;
+    std::vector<Value> stack;       // 演算スタック
+    std::vector<size_t> callStack;  // 戻り先アドレス
+    std::array<int32_t, FUNCTION_ID_MAX + 1> functionTable; // 関数ID → 本体の先頭
+
+    // 演算スタックから取り出す
+    Value pop() {
+        Value value = std::move(stack.back());
+        stack.pop_back();
+        return value;
+    }
+
+    // 同じ型同士の二項演算（結果はスタックトップに上書き）
+    template <typename T, typename F>
+    void binary(F f) {
+        T right = std::get<T>(stack.back());
+        stack.pop_back();
+        Value& left = stack.back();
+        left = f(std::get<T>(left), right);
+    }
+
+    // 型付きメモリプールへの格納（型が合わなければsetMemoryValueでエラーにする）
+    template <typename T, typename Slot>
+    void store(Slot&& slot, char type, int index) {
+        if (T* value = std::get_if<T>(&stack.back())) {
+            slot = std::move(*value);
+        } else {
+            interpreter.setMemoryValue(type, index, stack.back());
+        }
+        stack.pop_back();
+    }
+
+public:
+    VirtualMachine(Interpreter& interpreter);
+
+    // 実行
+    void run(const Bytecode& program);
+    // 前の実行で定義した関数を残したまま、entry の命令から実行（-n で2行目から本体だけを実行する）
+    void resume(const Bytecode& program, size_t entry);
+};
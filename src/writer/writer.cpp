@@ -0,0 +1,131 @@
+// SigNum Buffered Output Writer
+
+#include <charconv>
+#include <cstring>
+#include <iostream>
+#include "writer.hpp"
+#if defined(__unix__) || defined(__APPLE__)
+#define SIGNUM_ISATTY_SUPPORTED 1
+#include <unistd.h>
+#endif
+
+// double の固定小数点表記（小数6桁）の最大長（符号・整数部309桁・小数点・小数部）
+constexpr size_t MAX_FLOAT_LENGTH = 1 + 309 + 1 + 6;
+
+namespace {
+
+// 起動時の標準出力・標準エラーのバッファ（差し替えられていれば、端末かどうかはファイル記述子では分からない）
+std::streambuf* const standardOutputBuffer = std::cout.rdbuf();
+std::streambuf* const standardErrorBuffer = std::cerr.rdbuf();
+std::streambuf* const standardLogBuffer = std::clog.rdbuf();
+
+} // namespace
+
+OutputWriter::OutputWriter(std::ostream& stream)
+    : stream(&stream), buffer(OUTPUT_BUFFER_SIZE), lineBuffered(isTerminal(stream)) {}
+
+OutputWriter::~OutputWriter() {
+    // 例外で実行を抜けたときも、それまでの出力は失わない
+    if (used > 0) {
+        flush();
+    }
+}
+
+// 出力先を差し替える
+void OutputWriter::setStream(std::ostream& target) {
+    if (used > 0) {
+        flush();
+    }
+    stream = &target;
+    lineBuffered = isTerminal(target);
+}
+
+// バッファの中身を出力先に渡す
+void OutputWriter::drain() {
+    if (used > 0) {
+        std::streambuf* sink = stream->rdbuf();
+        if (!sink || sink->sputn(buffer.data(), static_cast<std::streamsize>(used)) != static_cast<std::streamsize>(used)) {
+            stream->setstate(std::ios::badbit);
+        }
+        used = 0;
+    }
+}
+
+// 書き込む前に n バイトの空きを作る
+char* OutputWriter::reserve(size_t n) {
+    if (buffer.size() - used < n) {
+        drain();
+    }
+    return buffer.data() + used;
+}
+
+// 文字列を書き込む
+void OutputWriter::write(std::string_view text) {
+    if (text.size() > buffer.size() - used) {
+        drain();
+        // バッファより大きい文字列は直接渡す
+        if (text.size() >= buffer.size()) {
+            std::streambuf* sink = stream->rdbuf();
+            if (!sink || sink->sputn(text.data(), static_cast<std::streamsize>(text.size())) !=
+                             static_cast<std::streamsize>(text.size())) {
+                stream->setstate(std::ios::badbit);
+            }
+            return;
+        }
+    }
+    std::memcpy(buffer.data() + used, text.data(), text.size());
+    used += text.size();
+}
+
+// 整数を書き込む
+void OutputWriter::write(int value) {
+    char* first = reserve(16);
+    used += static_cast<size_t>(std::to_chars(first, first + 16, value).ptr - first);
+}
+
+// 浮動小数点数を書き込む（std::to_string と同じ小数6桁の表記）
+void OutputWriter::write(double value) {
+    char* first = reserve(MAX_FLOAT_LENGTH);
+    auto result = std::to_chars(first, first + MAX_FLOAT_LENGTH, value, std::chars_format::fixed, 6);
+    used += static_cast<size_t>(result.ptr - first);
+}
+
+// 真偽値を書き込む
+void OutputWriter::write(bool value) {
+    write(std::string_view(value ? "true" : "false"));
+}
+
+// 行を終える
+void OutputWriter::endLine() {
+    *reserve(1) = '\n';
+    ++used;
+    if (lineBuffered) {
+        flush();
+    }
+}
+
+// バッファの中身を出力先に流して同期する
+void OutputWriter::flush() {
+    drain();
+    if (std::streambuf* sink = stream->rdbuf()) {
+        sink->pubsync();
+    }
+}
+
+// 出力先が端末か（常駐サーバーの子プロセスのように rdbuf を差し替えていれば端末ではない）
+bool OutputWriter::isTerminal(const std::ostream& target) {
+#ifdef SIGNUM_ISATTY_SUPPORTED
+    if (&target == &std::cout) {
+        return target.rdbuf() == standardOutputBuffer && isatty(STDOUT_FILENO);
+    }
+    if (&target == &std::cerr) {
+        return target.rdbuf() == standardErrorBuffer && isatty(STDERR_FILENO);
+    }
+    if (&target == &std::clog) {
+        return target.rdbuf() == standardLogBuffer && isatty(STDERR_FILENO);
+    }
+#else
+    (void)target;
+#endif
+    return false;
+}
@@ -0,0 +1,52 @@
+// SigNum Buffered Output Writer
+
+#pragma once
+
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+// 出力の書き込みバッファのサイズ
+constexpr size_t OUTPUT_BUFFER_SIZE = 1 << 16;
+
+// 出力文の値を大きなバッファに直接書式化して、まとめて出力先に流す
+// （std::endl の行ごとのフラッシュと valueToString の一時文字列を避ける）
+//
+// 端末への出力は行ごとに、それ以外はバッファが一杯になったときと flush() で流す
+class OutputWriter {
+private:
+    std::ostream* stream;
+    std::vector<char> buffer;
+    size_t used = 0;
+    bool lineBuffered = false;
+
+    // バッファの中身を出力先に渡す（出力先の同期はしない）
+    void drain();
+    // 書き込む前に n バイトの空きを作る
+    char* reserve(size_t n);
+
+public:
+    explicit OutputWriter(std::ostream& stream);
+    ~OutputWriter();
+    OutputWriter(const OutputWriter&) = delete;
+    OutputWriter& operator=(const OutputWriter&) = delete;
+
+    // 出力先を差し替える（それまでの出力は元の出力先に流す）
+    void setStream(std::ostream& target);
+    std::ostream& getStream() { return *stream; }
+
+    // 値を書き込む
+    void write(std::string_view text);
+    void write(int value);
+    void write(double value);
+    void write(bool value);
+
+    // 行を終える（行バッファのときはここで流す）
+    void endLine();
+
+    // バッファの中身を出力先に流して同期する
+    void flush();
+
+    // 出力先が端末か（端末なら行バッファにする）
+    static bool isTerminal(const std::ostream& target);
+};